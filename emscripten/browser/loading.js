@@ -0,0 +1,112 @@
+import axios from 'axios';
+
+export const PARAMS_URL = 'https://storage.googleapis.com/storage/v1/b/cubeartisan/o/draftbotparams.bin?alt=media';
+
+const DB_NAME = 'mtgdraftbots';
+const STORE_NAME = 'params';
+
+// A minimal module using a v128 instruction, it only validates where the runtime supports SIMD128.
+export const supportsSimd = () => {
+	try {
+		return WebAssembly.validate(new Uint8Array([
+			0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10, 1, 8, 0, 65, 0, 253, 15, 253, 98, 11,
+		]));
+	} catch (e) {
+		return false;
+	}
+};
+
+// The trained probability table the npm build copies next to the worker, null where it is not served and the
+// probabilities are generated instead.
+export const loadProbTable = () => fetch(new URL('prob_table.bin', self.location.href))
+	.then((response) => (response.ok ? response.arrayBuffer() : null))
+	.catch(() => null);
+
+const sha256 = async (bytes) => {
+	const digest = new Uint8Array(await crypto.subtle.digest('SHA-256', bytes));
+	return Array.from(digest, (b) => b.toString(16).padStart(2, '0')).join('');
+};
+
+const request = (req) => new Promise((resolve, reject) => {
+	req.onsuccess = () => resolve(req.result);
+	req.onerror = () => reject(req.error);
+});
+
+const openCache = () => {
+	if (typeof indexedDB === 'undefined') return Promise.resolve(null);
+	const req = indexedDB.open(DB_NAME, 1);
+	req.onupgradeneeded = () => req.result.createObjectStore(STORE_NAME);
+	return request(req).catch(() => null);
+};
+
+// Entries are stored by url along with the hash of their contents and the validators the server sent with them, an
+// entry is only used if it still hashes the same.
+const readCached = async (url) => {
+	const db = await openCache();
+	if (db === null) return null;
+	try {
+		const entry = await request(db.transaction(STORE_NAME, 'readonly').objectStore(STORE_NAME).get(url));
+		if (!entry || (await sha256(entry.data)) !== entry.hash) return null;
+		return entry;
+	} catch (e) {
+		return null;
+	} finally {
+		db.close();
+	}
+};
+
+const writeCacheEntry = async (url, entry) => {
+	const db = await openCache();
+	if (db === null) return;
+	try {
+		await request(db.transaction(STORE_NAME, 'readwrite').objectStore(STORE_NAME).put(entry, url));
+	} catch (e) {
+		console.warn('Could not cache the draftbot params', e);
+	} finally {
+		db.close();
+	}
+};
+
+// A cached copy is revalidated with the server before it is used, sending its ETag and Last-Modified so an unchanged
+// file costs a 304 instead of a download. Within maxAge milliseconds of the last check it is used without asking, and
+// if the server cannot be reached the cached copy is used anyway. Cross origin servers have to expose ETag and
+// Last-Modified through Access-Control-Expose-Headers, otherwise every load downloads the file again.
+export const fetchParams = async (url = PARAMS_URL, { refresh = false, maxAge = 0 } = {}) => {
+	const cached = refresh ? null : await readCached(url);
+	if (cached !== null && Date.now() - (cached.checkedAt ?? 0) < maxAge) return new Uint8Array(cached.data);
+	const headers = {};
+	if (cached !== null && cached.etag) headers['If-None-Match'] = cached.etag;
+	if (cached !== null && cached.lastModified) headers['If-Modified-Since'] = cached.lastModified;
+	let response;
+	try {
+		response = await axios.get(url, {
+			responseType: 'arraybuffer',
+			headers,
+			validateStatus: (status) => (status >= 200 && status < 300) || (cached !== null && status === 304),
+		});
+	} catch (e) {
+		if (cached === null) throw e;
+		console.warn('Could not revalidate the cached draftbot params, using them as they are', e);
+		return new Uint8Array(cached.data);
+	}
+	if (response.status === 304) {
+		await writeCacheEntry(url, { ...cached, checkedAt: Date.now() });
+		return new Uint8Array(cached.data);
+	}
+	await writeCacheEntry(url, {
+		hash: await sha256(response.data),
+		data: response.data,
+		etag: response.headers.etag,
+		lastModified: response.headers['last-modified'],
+		checkedAt: Date.now(),
+	});
+	return new Uint8Array(response.data);
+};
+
+// source can be the params themselves as an ArrayBuffer or typed array, or a url that is downloaded once and then
+// served from IndexedDB while the server reports it unchanged.
+export const loadParams = async (source, options) => {
+	if (source instanceof ArrayBuffer) return new Uint8Array(source);
+	if (ArrayBuffer.isView(source)) return source;
+	return fetchParams(source || PARAMS_URL, options);
+};
@@ -1,28 +1,105 @@
-import {Pool, spawn, Thread} from 'threads';
+import {Pool, spawn, Thread, Transfer} from 'threads';
 
-const createDraftbotsWorker = async (autoInitialize, url) => {
+import { decodeBotResult, decodeBotResults, encodePickBatch, encodePickRequest } from './wire.js';
+
+const createDraftbotsWorker = async (autoInitialize, source) => {
   const worker = await spawn(new Worker(new URL('./mtgdraftbotsWorker.js', import.meta.url)))
   if (autoInitialize) {
-    await worker.initializeDraftbots(url);
+    await worker.initializeDraftbots(source);
   }
   return worker;
 }
 
 let draftbots = createDraftbotsWorker(false);
 
-export const calculateBotPickFromOptions = async (drafterState, options) =>
-    (await draftbots).calculatePickFromOptions({ drafterState, options });
+const singleCardOptions = (drafterState) => drafterState.cardsInPack.map((_, i) => [i]);
+
+// The number of workers while draftbots is a pool, batches are split into one chunk per worker so every worker
+// scores part of them at the same time instead of one worker scoring all of them.
+let poolSize = 1;
+
+const splitBatch = (requests) => {
+  const numChunks = Math.min(poolSize, requests.length);
+  if (numChunks <= 1) return [requests];
+  const chunks = [];
+  for (let i = 0; i < numChunks; i++) {
+    chunks.push(requests.slice(Math.floor(i * requests.length / numChunks), Math.floor((i + 1) * requests.length / numChunks)));
+  }
+  return chunks;
+};
+
+const calculateChunk = async (requests) => {
+  const batch = encodePickBatch(requests);
+  const results = await (await draftbots).calculatePicksBinary(Transfer(batch));
+  if (results === null) throw new Error('The draftbots rejected the batch.');
+  return decodeBotResults(results, requests);
+};
+
+const calculateBatch = async (requests) => (await Promise.all(splitBatch(requests).map(calculateChunk))).flat();
+
+// Scores the picks for many drafters with a single call into the worker, or one call into each worker of a pool.
+// optionsPerState defaults to every card in the pack on its own for each drafter.
+export const calculateBotPicksBatch = async (drafterStates, optionsPerState = null, { explain = true } = {}) => {
+  const requests = drafterStates.map((drafterState, i) => ({
+    drafterState,
+    options: optionsPerState?.[i] ?? singleCardOptions(drafterState),
+    explain,
+  }));
+  const results = await calculateBatch(requests);
+  const error = results.find((result) => result instanceof Error);
+  if (error) throw error;
+  return results;
+};
+
+// With micro batching enabled single picks that arrive within windowMs of each other are sent as one batch.
+let microBatching = null;
+
+const flushMicroBatch = () => {
+  const { pending } = microBatching;
+  clearTimeout(microBatching.timer);
+  microBatching.pending = [];
+  microBatching.timer = null;
+  for (const chunk of splitBatch(pending)) {
+    calculateChunk(chunk).then(
+      (results) => results.forEach((result, i) => (result instanceof Error ? chunk[i].reject(result) : chunk[i].resolve(result))),
+      (error) => chunk.forEach(({ reject }) => reject(error)),
+    );
+  }
+};
+
+export const enableMicroBatching = ({ windowMs = 2, maxBatchSize = 64 } = {}) => {
+  if (microBatching?.pending.length) flushMicroBatch();
+  microBatching = { windowMs, maxBatchSize, pending: [], timer: null };
+};
 
-export const calculateBotPick = (drafterState) => {
-  const options = [];
-  for (let i = 0; i < drafterState.cardsInPack.length; i++) options.push([i]);
-  return calculateBotPickFromOptions(drafterState, options);
+export const disableMicroBatching = () => {
+  if (microBatching?.pending.length) flushMicroBatch();
+  microBatching = null;
 };
 
+// The request and result cross the worker boundary in the binary format from wire.js and are transferred rather
+// than cloned. With explain false the scores only hold the score and lands of each option.
+export const calculateBotPickFromOptions = async (drafterState, options, { explain = true } = {}) => {
+  if (microBatching !== null) {
+    return new Promise((resolve, reject) => {
+      microBatching.pending.push({ drafterState, options, explain, resolve, reject });
+      if (microBatching.pending.length >= microBatching.maxBatchSize) flushMicroBatch();
+      else if (microBatching.timer === null) microBatching.timer = setTimeout(flushMicroBatch, microBatching.windowMs);
+    });
+  }
+  const request = encodePickRequest(drafterState, options, { explain });
+  const result = await (await draftbots).calculatePickBinary(Transfer(request));
+  if (result === null) throw new Error('The draftbots rejected the pick request.');
+  return decodeBotResult(result, drafterState, options);
+};
+
+export const calculateBotPick = (drafterState, pickOptions) =>
+    calculateBotPickFromOptions(drafterState, singleCardOptions(drafterState), pickOptions);
+
 export const testRecognized = async (oracleIds) => (await draftbots).testRecognized(oracleIds);
 
-export const initializeDraftbots = async (url) => {
-  await (await draftbots).initializeDraftbots(url);
+export const initializeDraftbots = async (source) => {
+  await (await draftbots).initializeDraftbots(source);
   return true;
 }
 
@@ -30,6 +107,7 @@ export const terminateDraftbots = async () => {
   const worker = await draftbots;
   if (worker) {
     draftbots = null;
+    poolSize = 1;
     if (worker.queue) {
       worker.terminate();
     } else {
@@ -39,22 +117,23 @@ export const terminateDraftbots = async () => {
   return true;
 }
 
-export const restartDraftbots = async (url) => {
+export const restartDraftbots = async (source) => {
   const worker = await draftbots;
   if (worker !== null) {
     await terminateDraftbots()
   }
-  draftbots = createDraftbotsWorker(true, url);
+  draftbots = createDraftbotsWorker(true, source);
   await draftbots;
   return true;
 }
 
-export const startPool = async (numWorkers = 4, url) => {
+export const startPool = async (numWorkers = 4, source) => {
   const worker = await draftbots;
   if (worker !== null) await terminateDraftbots();
   draftbots = new Promise((resolve) => {
     if (!numWorkers) numWorkers = 4;
-    const pool = Pool(() => createDraftbotsWorker(true, url), {name: 'MtgDraftBots', size: numWorkers});
+    poolSize = numWorkers;
+    const pool = Pool(() => createDraftbotsWorker(true, source), {name: 'MtgDraftBots', size: numWorkers});
     resolve(new Proxy(pool, {
       get: (target, name, receiver) => {
         if (Reflect.has(target, name)) {
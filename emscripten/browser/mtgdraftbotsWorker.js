@@ -1,26 +1,48 @@
-import axios from 'axios';
-import { expose } from 'threads/worker';
+import { expose, Transfer } from 'threads/worker';
 
-import createMtgDraftBots from './MtgDraftBotsWasmWebWorker.js';
-import MtgDraftBotsWasm from './MtgDraftBotsWasmWebWorker.wasm';
+import createMtgDraftBotsBaseline from './MtgDraftBotsWasmWebWorker.js';
+import MtgDraftBotsWasmBaseline from './MtgDraftBotsWasmWebWorker.wasm';
+import createMtgDraftBotsSimd from './MtgDraftBotsWasmWebWorkerSimd.js';
+import MtgDraftBotsWasmSimd from './MtgDraftBotsWasmWebWorkerSimd.wasm';
+import { loadParams, loadProbTable, supportsSimd } from './loading.js';
+
+const useSimd = supportsSimd();
+const createMtgDraftBots = useSimd ? createMtgDraftBotsSimd : createMtgDraftBotsBaseline;
+const MtgDraftBotsWasm = useSimd ? MtgDraftBotsWasmSimd : MtgDraftBotsWasmBaseline;
 
 const timeout = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+// The trained probability table has to be in place before the params, loading them fills the slabs their costs use.
+const withProbTable = async (module) => {
+	const table = await loadProbTable();
+	if (table === null || !module.initializeProbTable(table, table.byteLength)) {
+		console.warn('The trained probability table is missing, the probabilities are generated instead.');
+	}
+	return module;
+};
+
 const MtgDraftBots = createMtgDraftBots({
 			locateFile: (path) => {
 			  if (path.endsWith('.wasm')) return MtgDraftBotsWasm;
 			  return path;
 			},
-		  });
+		  }).then(withProbTable);
 
 expose({
 	calculatePickFromOptions: async ({ drafterState, options }) =>
 		(await MtgDraftBots).calculatePickFromOptions(drafterState, options),
-	initializeDraftbots: async (url) => {
-		const response = await axios.get(
-			"https://storage.googleapis.com/storage/v1/b/cubeartisan/o/draftbotparams.bin?alt=media",
-			{ responseType: 'arraybuffer' },
-		);
-		return (await MtgDraftBots).initializeDraftbots(response.data, response.data.length ?? response.data.byteLength);
+	calculatePickBinary: async (request) => {
+		const result = (await MtgDraftBots).calculatePickBinary(new Uint8Array(request));
+		return result === null ? null : Transfer(result.buffer);
+	},
+	calculatePicksBinary: async (batch) => {
+		const results = (await MtgDraftBots).calculatePicksBinary(new Uint8Array(batch));
+		return results === null ? null : Transfer(results.buffer);
+	},
+	initializeDraftbots: async (source, options) => {
+		const params = await loadParams(source, options);
+		return (await MtgDraftBots).initializeDraftbots(params, params.byteLength);
 	},
 	testRecognized: async (oracleIds) => (await MtgDraftBots).testRecognized(oracleIds),
+	activeInstructionSet: async () => (await MtgDraftBots).activeInstructionSet(),
 });
@@ -24,7 +24,8 @@ interface OracleResult {
 interface BotScore {
     score: number;
     lands: number[];
-    oracleResults: OracleResult[];
+    // Left out when the pick was calculated with explain false.
+    oracleResults?: OracleResult[];
 }
 
 interface BotResult extends DrafterState {
@@ -33,18 +34,46 @@ interface BotResult extends DrafterState {
     scores: BotScore[];
 }
 
-declare function calculateBotPick(drafterState: DrafterState) : Promise<BotResult>;
+interface PickOptions {
+    // Include the oracle breakdown of every option, defaults to true.
+    explain?: boolean;
+}
+
+declare function calculateBotPick(drafterState: DrafterState, pickOptions?: PickOptions) : Promise<BotResult>;
+
+declare function calculateBotPickFromOptions(drafterState: DrafterState, options: number[][], pickOptions?: PickOptions) : Promise<BotResult>;
+
+// optionsPerState defaults to every card in the pack on its own for each drafter.
+declare function calculateBotPicksBatch(drafterStates: DrafterState[], optionsPerState?: number[][][] | null,
+                                        pickOptions?: PickOptions) : Promise<BotResult[]>;
+
+interface MicroBatchingOptions {
+    // How long to wait for more picks before sending a batch, defaults to 2.
+    windowMs?: number;
+    // Send the batch as soon as it has this many picks, defaults to 64.
+    maxBatchSize?: number;
+}
+
+declare function enableMicroBatching(microBatchingOptions?: MicroBatchingOptions) : void;
+
+declare function disableMicroBatching() : void;
 
-declare function calculateBotPickFromOptions(drafterState: DrafterState, options: number[][]) : Promise<BotResult>;
+// A url, a local path (Node only) or the contents of a params file.
+type ParamsSource = string | ArrayBuffer | Uint8Array;
 
-declare function initializeDraftbots(url: string) : Promise<boolean>;
+declare function initializeDraftbots(source?: ParamsSource) : Promise<boolean>;
 
 declare function testRecognized(oracleIds: string[]) : Promise<boolean[]>;
 
 declare function terminateDraftbots() : Promise<boolean>;
 
-declare function restartDraftbots(url: string) : Promise<boolean>;
+declare function restartDraftbots(source?: ParamsSource) : Promise<boolean>;
+
+interface PoolOptions {
+    // Download the params and compile the wasm once, sharing both with every worker.
+    sharedMemory?: boolean;
+}
 
-declare function startPool(numWorkers: number, url: string) : Promise<boolean>;
+declare function startPool(numWorkers: number, source?: ParamsSource, poolOptions?: PoolOptions) : Promise<boolean>;
 
 declare const COLOR_COMBINATIONS: string[];
\ No newline at end of file
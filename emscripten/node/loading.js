@@ -0,0 +1,123 @@
+import axios from 'axios';
+import { createHash } from 'crypto';
+import { mkdir, readFile, rename, unlink, writeFile } from 'fs/promises';
+import { homedir } from 'os';
+import { join } from 'path';
+import { fileURLToPath } from 'url';
+
+export const PARAMS_URL = 'https://storage.googleapis.com/storage/v1/b/cubeartisan/o/draftbotparams.bin?alt=media';
+
+const CACHE_DIR = process.env.MTGDRAFTBOTS_CACHE_DIR ?? join(homedir(), '.cache', 'mtgdraftbots');
+const CACHE_INDEX = join(CACHE_DIR, 'index.json');
+
+// A minimal module using a v128 instruction, it only validates where the runtime supports SIMD128.
+export const supportsSimd = () => {
+  try {
+    return WebAssembly.validate(new Uint8Array([
+      0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10, 1, 8, 0, 65, 0, 253, 15, 253, 98, 11,
+    ]));
+  } catch (e) {
+    return false;
+  }
+};
+
+export const wasmModuleUrl = (simd) =>
+    new URL(simd ? './MtgDraftBotsWasmNodeWorkerSimd.wasm' : './MtgDraftBotsWasmNodeWorker.wasm', import.meta.url);
+
+// The trained probability table the npm build copies next to the modules, null where the package was built without
+// it and the probabilities are generated instead.
+export const loadProbTable = () => readFile(new URL('./prob_table.bin', import.meta.url)).catch(() => null);
+
+const sha256 = (bytes) => createHash('sha256').update(bytes).digest('hex');
+
+const readCacheIndex = async () => {
+  try {
+    return JSON.parse(await readFile(CACHE_INDEX, 'utf8'));
+  } catch (e) {
+    return {};
+  }
+};
+
+// The cache keeps each download under the hash of its contents and maps the url to that hash and the validators the
+// server sent with it, a file is only used if it still hashes to its name.
+const readCacheEntry = async (url) => {
+  const entry = (await readCacheIndex())[url];
+  // Older caches mapped the url to just the hash.
+  return typeof entry === 'string' ? { hash: entry } : entry ?? null;
+};
+
+const readCached = async (entry) => {
+  if (!entry?.hash) return null;
+  try {
+    const bytes = await readFile(join(CACHE_DIR, `${entry.hash}.bin`));
+    return sha256(bytes) === entry.hash ? bytes : null;
+  } catch (e) {
+    return null;
+  }
+};
+
+const writeCacheEntry = async (url, entry) => {
+  const index = await readCacheIndex();
+  const previous = typeof index[url] === 'string' ? index[url] : index[url]?.hash;
+  index[url] = entry;
+  await writeFile(`${CACHE_INDEX}.${process.pid}.tmp`, JSON.stringify(index));
+  await rename(`${CACHE_INDEX}.${process.pid}.tmp`, CACHE_INDEX);
+  const hashes = Object.values(index).map((value) => (typeof value === 'string' ? value : value.hash));
+  if (previous && previous !== entry.hash && !hashes.includes(previous)) {
+    await unlink(join(CACHE_DIR, `${previous}.bin`)).catch(() => {});
+  }
+};
+
+const writeCached = async (url, bytes, validators) => {
+  const hash = sha256(bytes);
+  try {
+    await mkdir(CACHE_DIR, { recursive: true });
+    const temp = join(CACHE_DIR, `${hash}.${process.pid}.tmp`);
+    await writeFile(temp, bytes);
+    await rename(temp, join(CACHE_DIR, `${hash}.bin`));
+    await writeCacheEntry(url, { hash, ...validators, checkedAt: Date.now() });
+  } catch (e) {
+    console.warn('Could not cache the draftbot params', e);
+  }
+};
+
+// A cached copy is revalidated with the server before it is used, sending its ETag and Last-Modified so an unchanged
+// file costs a 304 instead of a download. Within maxAge milliseconds of the last check it is used without asking, and
+// if the server cannot be reached the cached copy is used anyway.
+export const fetchParams = async (url = PARAMS_URL, { refresh = false, maxAge = 0 } = {}) => {
+  const entry = refresh ? null : await readCacheEntry(url);
+  const cached = await readCached(entry);
+  if (cached !== null && Date.now() - (entry.checkedAt ?? 0) < maxAge) return cached;
+  const headers = { "Content-Type": "application/json" };
+  if (cached !== null && entry.etag) headers['If-None-Match'] = entry.etag;
+  if (cached !== null && entry.lastModified) headers['If-Modified-Since'] = entry.lastModified;
+  let response;
+  try {
+    response = await axios.get(url, {
+      responseType: 'arraybuffer',
+      headers,
+      validateStatus: (status) => (status >= 200 && status < 300) || (cached !== null && status === 304),
+    });
+  } catch (e) {
+    if (cached === null) throw e;
+    console.warn('Could not revalidate the cached draftbot params, using them as they are', e);
+    return cached;
+  }
+  if (response.status === 304) {
+    await writeCacheEntry(url, { ...entry, checkedAt: Date.now() }).catch(() => {});
+    return cached;
+  }
+  const bytes = Buffer.from(response.data);
+  await writeCached(url, bytes, { etag: response.headers.etag, lastModified: response.headers['last-modified'] });
+  return bytes;
+};
+
+// source can be the params themselves as an ArrayBuffer or typed array, a local path or file: url, or an http(s)
+// url that is downloaded once and then served from the cache while the server reports it unchanged.
+export const loadParams = async (source, options) => {
+  if (source instanceof ArrayBuffer || source instanceof SharedArrayBuffer) return new Uint8Array(source);
+  if (ArrayBuffer.isView(source)) return source;
+  if (!source) return fetchParams(PARAMS_URL, options);
+  if (/^https?:/.test(source)) return fetchParams(source, options);
+  return readFile(source.startsWith('file:') ? fileURLToPath(source) : source);
+};
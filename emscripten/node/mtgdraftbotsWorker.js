@@ -1,24 +1,58 @@
-import axios from 'axios';
-import { expose } from 'threads/worker';
-import { fileURLToPath } from 'url';
+import { expose, Transfer } from 'threads/worker';
 
-import createMtgDraftBots from './MtgDraftBotsWasmNodeWorker.cjs';
+import createMtgDraftBotsBaseline from './MtgDraftBotsWasmNodeWorker.cjs';
+import createMtgDraftBotsSimd from './MtgDraftBotsWasmNodeWorkerSimd.cjs';
+import { loadParams, loadProbTable, supportsSimd } from './loading.js';
 
-const MtgDraftBotsWasm = fileURLToPath(new URL('./MtgDraftBotWasmWorker.wasm', import.meta.url));
+let MtgDraftBots = null;
 
-const MtgDraftBots = createMtgDraftBots();
+// The trained probability table has to be in place before the params, loading them fills the slabs their costs use.
+const withProbTable = async (module) => {
+  const table = await loadProbTable();
+  if (table === null || !module.initializeProbTable(table, table.byteLength)) {
+    console.warn('The trained probability table is missing, the probabilities are generated instead.');
+  }
+  return module;
+};
+
+// The module is created on first use so a pool can hand every worker the WebAssembly.Module it compiled once
+// instead of each worker reading and compiling the .wasm file itself.
+const getMtgDraftBots = (wasmModule = null, simd = supportsSimd()) => {
+  if (MtgDraftBots === null) {
+    const createMtgDraftBots = simd ? createMtgDraftBotsSimd : createMtgDraftBotsBaseline;
+    MtgDraftBots = createMtgDraftBots(wasmModule === null ? {} : {
+      instantiateWasm: (imports, receiveInstance) => {
+        WebAssembly.instantiate(wasmModule, imports).then((instance) => receiveInstance(instance, wasmModule));
+        return {};
+      },
+    }).then(withProbTable);
+  }
+  return MtgDraftBots;
+};
 
 const timeout = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
 
 expose({
   calculatePickFromOptions: async ({ drafterState, options }) =>
-      (await MtgDraftBots).calculatePickFromOptions(drafterState, options),
-  initializeDraftbots: async (url) => {
-    const response = await axios.get(
-        "https://storage.googleapis.com/storage/v1/b/cubeartisan/o/draftbotparams.bin?alt=media",
-        { responseType: 'arraybuffer', headers: { "Content-Type": "application/json" } },
-    );
-    return (await MtgDraftBots).initializeDraftbots(response.data, response.data.length ?? response.data.byteLength);
+      (await getMtgDraftBots()).calculatePickFromOptions(drafterState, options),
+  calculatePickBinary: async (request) => {
+    const result = (await getMtgDraftBots()).calculatePickBinary(new Uint8Array(request));
+    return result === null ? null : Transfer(result.buffer);
+  },
+  calculatePicksBinary: async (batch) => {
+    const results = (await getMtgDraftBots()).calculatePicksBinary(new Uint8Array(batch));
+    return results === null ? null : Transfer(results.buffer);
+  },
+  initializeDraftbots: async (source, options) => {
+    const params = await loadParams(source, options);
+    return (await getMtgDraftBots()).initializeDraftbots(params, params.byteLength);
+  },
+  // params is a SharedArrayBuffer the pool downloaded once, it is only ever read. initializeDraftbots copies it
+  // into this instance's heap since the wasm memory is not shared.
+  attachDraftbots: async ({ params, wasmModule, simd }) => {
+    const bytes = new Uint8Array(params);
+    return (await getMtgDraftBots(wasmModule, simd)).initializeDraftbots(bytes, bytes.byteLength);
   },
-  testRecognized: async (oracleIds) => (await MtgDraftBots).testRecognized(oracleIds),
+  testRecognized: async (oracleIds) => (await getMtgDraftBots()).testRecognized(oracleIds),
+  activeInstructionSet: async () => (await getMtgDraftBots()).activeInstructionSet(),
 });
@@ -0,0 +1,86 @@
+// The same API as mtgdraftbots.js backed by the native Node-API addon instead of a wasm worker. Picks run on the
+// libuv thread pool, so UV_THREADPOOL_SIZE takes the place of the worker pool size.
+import { createRequire } from 'module';
+import { fileURLToPath } from 'url';
+
+import { loadParams } from './loading.js';
+
+export { COLOR_COMBINATIONS } from './colors.js';
+
+// The addon loads the trained probability table the npm build copies here, unless the environment names another one.
+process.env.MTGDRAFTBOTS_PROB_TABLE ??= fileURLToPath(new URL('./prob_table.bin', import.meta.url));
+
+const require = createRequire(import.meta.url);
+const addon = require('./MtgDraftBotsNodeAddon.node');
+
+let initialized = null;
+
+// Picks handed to the addon that have not settled yet. Replacing the params waits for these and every call waits for
+// the latest initialized, so new picks never start while the params are being replaced. The addon also locks
+// around the swap, this keeps the pool threads from blocking on it.
+const inFlight = new Set();
+
+const track = (promise) => {
+  inFlight.add(promise);
+  const remove = () => inFlight.delete(promise);
+  promise.then(remove, remove);
+  return promise;
+};
+
+// initialized can be replaced while waiting on it, in which case the new one has to be waited on too.
+const whenInitialized = async () => {
+  let current;
+  do {
+    current = initialized;
+    await current;
+  } while (current !== initialized);
+};
+
+const singleCardOptions = (drafterState) => drafterState.cardsInPack.map((_, i) => [i]);
+
+export const calculateBotPickFromOptions = async (drafterState, options, { explain = true } = {}) => {
+  await whenInitialized();
+  return track(addon.calculatePickFromOptions(drafterState, options, explain));
+};
+
+export const calculateBotPick = (drafterState, pickOptions) =>
+    calculateBotPickFromOptions(drafterState, singleCardOptions(drafterState), pickOptions);
+
+export const calculateBotPicksBatch = async (drafterStates, optionsPerState = null, { explain = true } = {}) => {
+  await whenInitialized();
+  return track(addon.calculatePicksBatch(drafterStates, drafterStates.map((drafterState, i) => optionsPerState?.[i] ?? singleCardOptions(drafterState)), explain));
+};
+
+export const testRecognized = async (oracleIds) => {
+  await whenInitialized();
+  return addon.testRecognized(oracleIds);
+};
+
+// Local paths are memory mapped by the addon, anything else goes through the same loading and caching as the workers.
+// A failure resolves false like params the addon rejects, initialized never rejects so later calls can still wait on
+// it and initialize again.
+export const initializeDraftbots = async (source) => {
+  const isLocalPath = typeof source === 'string' && !/^https?:/.test(source);
+  const params = isLocalPath ? (source.startsWith('file:') ? fileURLToPath(source) : source) : await loadParams(source);
+  const previous = initialized;
+  initialized = Promise.allSettled([previous, ...inFlight])
+    .then(() => addon.initializeDraftbots(params))
+    .catch((error) => {
+      console.error('Could not initialize the draftbots:', error);
+      return false;
+    });
+  return initialized;
+};
+
+export const activeInstructionSet = async () => addon.activeInstructionSet();
+
+// There are no workers to manage, these only exist so this module can replace mtgdraftbots.js.
+export const terminateDraftbots = async () => true;
+
+export const restartDraftbots = (source) => initializeDraftbots(source);
+
+export const startPool = (numWorkers, source) => initializeDraftbots(source);
+
+export const enableMicroBatching = () => {};
+
+export const disableMicroBatching = () => {};
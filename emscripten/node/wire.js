@@ -0,0 +1,152 @@
+// The binary encoding of pick requests and results described in include/mtgdraftbots/wire.hpp. Requests are
+// encoded into a fresh ArrayBuffer so they can be transferred to the worker, and results are viewed in place with
+// the breakdown only decoded when it is read.
+const REQUEST_MAGIC = 0x5142444D;
+const RESULT_MAGIC = 0x5242444D;
+const BATCH_MAGIC = 0x4242444D;
+const VERSION = 1;
+const EXPLAIN = 1;
+const REQUEST_HEADER_WORDS = 15;
+const RESULT_HEADER_WORDS = 8;
+const LANDS_SIZE = 32;
+
+const align = (byteLength) => (byteLength + 3) & ~3;
+
+export const encodePickRequest = (drafterState, options, { explain = true } = {}) => {
+  const encoder = new TextEncoder();
+  const oracleIds = drafterState.cardOracleIds.map((oracleId) => encoder.encode(oracleId));
+  const oracleIdsLength = oracleIds.reduce((length, oracleId) => length + oracleId.length, 0);
+  const numOptionCards = options.reduce((count, option) => count + option.length, 0);
+  const numWords = REQUEST_HEADER_WORDS + drafterState.picked.length + drafterState.seen.length
+    + drafterState.cardsInPack.length + drafterState.basics.length + options.length + 1 + numOptionCards
+    + oracleIds.length + 1;
+  const buffer = new ArrayBuffer(4 * numWords + align(oracleIdsLength));
+  const words = new Uint32Array(buffer, 0, numWords);
+  let position = 0;
+  const write = (values) => {
+    words.set(values, position);
+    position += values.length;
+  };
+  write([
+    REQUEST_MAGIC, VERSION, explain ? EXPLAIN : 0, drafterState.packNum, drafterState.numPacks, drafterState.pickNum,
+    drafterState.numPicks, drafterState.seed, drafterState.picked.length, drafterState.seen.length,
+    drafterState.cardsInPack.length, drafterState.basics.length, options.length, numOptionCards, oracleIds.length,
+  ]);
+  write(drafterState.picked);
+  write(drafterState.seen);
+  write(drafterState.cardsInPack);
+  write(drafterState.basics);
+  let offset = 0;
+  write([0, ...options.map((option) => offset += option.length)]);
+  for (const option of options) write(option);
+  offset = 0;
+  write([0, ...oracleIds.map((oracleId) => offset += oracleId.length)]);
+  const bytes = new Uint8Array(buffer, 4 * numWords);
+  offset = 0;
+  for (const oracleId of oracleIds) {
+    bytes.set(oracleId, offset);
+    offset += oracleId.length;
+  }
+  return buffer;
+};
+
+// Replaces the getter with the value on first read.
+const defineLazy = (object, name, compute) => Object.defineProperty(object, name, {
+  configurable: true,
+  enumerable: true,
+  get: () => {
+    const value = compute();
+    Object.defineProperty(object, name, { value, enumerable: true, writable: true });
+    return value;
+  },
+});
+
+// Returns the same shape as the object based API, taking the DrafterState and options from the request instead of
+// having them echoed back. Without explain the scores have no oracleResults.
+export const decodeBotResult = (buffer, drafterState, options, byteOffset = 0) => {
+  const header = new Uint32Array(buffer, byteOffset, RESULT_HEADER_WORDS);
+  if (header[0] !== RESULT_MAGIC || header[1] !== VERSION) throw new Error(`Not a version ${VERSION} draftbots result.`);
+  const [, , flags, chosenOption, numOptions, numRecognized, numOracleResults, numTitles] = header;
+  let offset = byteOffset + 4 * RESULT_HEADER_WORDS;
+  const take = (ArrayType, count) => {
+    const view = new ArrayType(buffer, offset, count);
+    offset += align(count * ArrayType.BYTES_PER_ELEMENT);
+    return view;
+  };
+  const scores = take(Float32Array, numOptions);
+  const lands = take(Uint8Array, numOptions * LANDS_SIZE);
+  const recognized = take(Uint8Array, numRecognized);
+  let oracleResults = null;
+  if (flags & EXPLAIN) {
+    const resultOffsets = take(Uint32Array, numOptions + 1);
+    const titleIndices = take(Uint32Array, numOracleResults);
+    const weights = take(Float32Array, numOracleResults);
+    const values = take(Float32Array, numOracleResults);
+    const perCardOffsets = take(Uint32Array, numOracleResults + 1);
+    const perCard = take(Float32Array, perCardOffsets[numOracleResults]);
+    const titleOffsets = take(Uint32Array, 2 * numTitles + 1);
+    const decoder = new TextDecoder();
+    const titles = [];
+    for (let i = 0; i < 2 * numTitles; i++) {
+      titles.push(decoder.decode(new Uint8Array(buffer, offset + titleOffsets[i], titleOffsets[i + 1] - titleOffsets[i])));
+    }
+    oracleResults = (option) => {
+      const results = [];
+      for (let i = resultOffsets[option]; i < resultOffsets[option + 1]; i++) {
+        results.push({
+          title: titles[2 * titleIndices[i]],
+          tooltip: titles[2 * titleIndices[i] + 1],
+          weight: weights[i],
+          value: values[i],
+          per_card: Array.from(perCard.subarray(perCardOffsets[i], perCardOffsets[i + 1])),
+        });
+      }
+      return results;
+    };
+  }
+  const result = { ...drafterState, options, chosenOption };
+  defineLazy(result, 'recognized', () => Array.from(recognized));
+  defineLazy(result, 'scores', () => {
+    const botScores = [];
+    for (let option = 0; option < numOptions; option++) {
+      const botScore = {
+        score: scores[option],
+        lands: Array.from(lands.subarray(option * LANDS_SIZE, (option + 1) * LANDS_SIZE)),
+      };
+      if (oracleResults !== null) defineLazy(botScore, 'oracleResults', () => oracleResults(option));
+      botScores.push(botScore);
+    }
+    return botScores;
+  });
+  return result;
+};
+
+// requests is a list of { drafterState, options, explain }, encoded as one buffer the worker reads in a single call.
+export const encodePickBatch = (requests) => {
+  const messages = requests.map(({ drafterState, options, explain }) => encodePickRequest(drafterState, options, { explain }));
+  const headerWords = 4 + messages.length;
+  const buffer = new ArrayBuffer(4 * headerWords + messages.reduce((length, message) => length + message.byteLength, 0));
+  const header = new Uint32Array(buffer, 0, headerWords);
+  header.set([BATCH_MAGIC, VERSION, messages.length]);
+  const bytes = new Uint8Array(buffer);
+  let offset = 4 * headerWords;
+  header[3] = offset;
+  messages.forEach((message, i) => {
+    bytes.set(new Uint8Array(message), offset);
+    offset += message.byteLength;
+    header[4 + i] = offset;
+  });
+  return buffer;
+};
+
+// Returns one entry per request, either its lazily decoded result or an Error if the request was rejected.
+export const decodeBotResults = (buffer, requests) => {
+  const [magic, version, count] = new Uint32Array(buffer, 0, 3);
+  if (magic !== BATCH_MAGIC || version !== VERSION || count !== requests.length) {
+    throw new Error(`Not a version ${VERSION} draftbots batch of ${requests.length} results.`);
+  }
+  const offsets = new Uint32Array(buffer, 12, count + 1);
+  return requests.map(({ drafterState, options }, i) => (offsets[i + 1] > offsets[i]
+    ? decodeBotResult(buffer, drafterState, options, offsets[i])
+    : new Error('The draftbots rejected the pick request.')));
+};
@@ -1,6 +1,7 @@
 #ifndef MTGDRAFTBOTS_DETAILS_CARDCOST_HPP
 #define MTGDRAFTBOTS_DETAILS_CARDCOST_HPP
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <cstring>
@@ -16,6 +17,7 @@
 #include "mtgdraftbots/details/simd.hpp"
 #include "mtgdraftbots/types.hpp"
 #include "mtgdraftbots/details/constants.hpp"
+#include "mtgdraftbots/details/prob_table.hpp"
 
 namespace mtgdraftbots::details {
     constexpr std::array<LandsMask, 32> MASK_BY_COMB_INDEX = ([]() {
@@ -34,6 +36,18 @@ namespace mtgdraftbots::details {
         return result;
         })();
 
+    // For each land combination a bitset of which of a requirement's masks include it. Moving lands from one
+    // combination to another can only change the probability of the requirement when their entries differ.
+    using LandsClasses = std::array<std::uint8_t, 32>;
+
+    constexpr void add_lands_class(LandsClasses& classes, const LandsMask& mask, std::size_t bit) noexcept {
+        for (std::size_t i = 0; i < classes.size(); i++) {
+            if (mask[i] == Mask::ON) classes[i] |= static_cast<std::uint8_t>(1u << bit);
+        }
+    }
+
+    struct CostBuckets;
+
     // This doesn't make the code faster to template, but makes some things cleaner.
     template<std::uint8_t>
     struct ManaRequirements;
@@ -42,32 +56,39 @@ namespace mtgdraftbots::details {
     struct ManaRequirements<0> {
          constexpr auto calculate_probability(const Lands&) const noexcept -> float { return 1.f; }
 
+         constexpr auto lands_classes() const noexcept -> LandsClasses { return { 0 }; }
+
          constexpr bool operator==(const ManaRequirements&) const noexcept { return true; }
     };
 
     template<>
     struct ManaRequirements<1> {
-        constexpr auto calculate_probability(const Lands& lands) const noexcept -> float {
+        auto calculate_probability(const Lands& lands) const noexcept -> float {
             using namespace constants;
-            const std::uint8_t usable = sum_masked(valid_lands, lands);
+            const std::uint32_t usable = std::min<std::uint32_t>(sum_masked(valid_lands, lands), MAX_USABLE);
             // We convert back to float here from 16 bit fixed point.
-            return constants::PROB_TABLE[offset | usable];
+            return prob_table[prob_index(offset, usable)];
         }
 
-        constexpr ManaRequirements(std::size_t combIndex, std::size_t devotionCount,
-                                   std::size_t cmc) noexcept
+        constexpr auto lands_classes() const noexcept -> LandsClasses {
+            LandsClasses result{ 0 };
+            add_lands_class(result, valid_lands, 0);
+            return result;
+        }
+
+        // Constructing a requirement fills the slab of prob_table it reads, so calculate_probability can index it
+        // directly.
+        ManaRequirements(std::size_t combIndex, std::size_t devotionCount, std::size_t cmc)
                 : valid_lands{MASK_BY_COMB_INDEX[combIndex]},
-                  offset(((std::min(cmc,constants::NUM_CMC - 1) * constants::NUM_REQUIRED_A
-                                  + std::min(devotionCount,constants::NUM_REQUIRED_A - 1)) * constants::NUM_REQUIRED_B)
-                         << (3 * constants::COUNT_DIMS_EXP))
-        { }
+                  offset(constants::prob_slab_offset(cmc, devotionCount, 0)) {
+            prob_table.ensure_slab(offset);
+        }
 
-        constexpr ManaRequirements(const LandsMask& mask, std::size_t devotionCount, std::size_t cmc) noexcept
+        ManaRequirements(const LandsMask& mask, std::size_t devotionCount, std::size_t cmc)
                 : valid_lands{mask},
-                  offset(((std::min(cmc,constants::NUM_CMC - 1) * constants::NUM_REQUIRED_A
-                                  + std::min(devotionCount,constants::NUM_REQUIRED_A - 1)) * constants::NUM_REQUIRED_B)
-                         << (3 * constants::COUNT_DIMS_EXP))
-        { }
+                  offset(constants::prob_slab_offset(cmc, devotionCount, 0)) {
+            prob_table.ensure_slab(offset);
+        }
 
 
         constexpr ManaRequirements() noexcept = default;
@@ -79,6 +100,7 @@ namespace mtgdraftbots::details {
 
         template<std::uint8_t n>
         friend struct ManaRequirements;
+        friend struct CostBuckets;
 
     private:
         LandsMask valid_lands{Mask::OFF};
@@ -87,27 +109,33 @@ namespace mtgdraftbots::details {
 
     template<>
     struct ManaRequirements<2> {
-        constexpr auto calculate_probability(const Lands& lands) const noexcept -> float {
+        auto calculate_probability(const Lands& lands) const noexcept -> float {
             using namespace constants;
-            const std::uint32_t usable_a  = sum_masked( valid_lands_a, lands);
-            const std::uint32_t usable_b  = sum_masked( valid_lands_b, lands);
-            const std::uint32_t usable_ab = sum_masked(valid_lands_ab, lands);
-            return PROB_TABLE[
-                offset | (usable_ab << (2 * COUNT_DIMS_EXP)) | (usable_b << COUNT_DIMS_EXP) | usable_a
-            ];
+            const std::uint32_t usable_a  = std::min<std::uint32_t>(sum_masked( valid_lands_a, lands), MAX_USABLE);
+            const std::uint32_t usable_b  = std::min<std::uint32_t>(sum_masked( valid_lands_b, lands), MAX_USABLE);
+            const std::uint32_t usable_ab = std::min<std::uint32_t>(sum_masked(valid_lands_ab, lands), MAX_USABLE);
+            return prob_table[prob_index(offset, usable_a, usable_b, usable_ab)];
+        }
+
+        constexpr auto lands_classes() const noexcept -> LandsClasses {
+            LandsClasses result{ 0 };
+            add_lands_class(result, valid_lands_a, 0);
+            add_lands_class(result, valid_lands_b, 1);
+            add_lands_class(result, valid_lands_ab, 2);
+            return result;
         }
 
-        constexpr ManaRequirements(std::size_t combAIndex, std::size_t devotionACount,
-                                   std::size_t combBIndex, std::size_t devotionBCount,
-                                   std::size_t cmc) noexcept 
+        ManaRequirements(std::size_t combAIndex, std::size_t devotionACount,
+                         std::size_t combBIndex, std::size_t devotionBCount,
+                         std::size_t cmc)
                 : valid_lands_a(MASK_BY_COMB_INDEX[combAIndex] & ~MASK_BY_COMB_INDEX[combBIndex]),
                   valid_lands_b(MASK_BY_COMB_INDEX[combBIndex] & ~MASK_BY_COMB_INDEX[combAIndex]),
                   valid_lands_ab(MASK_BY_COMB_INDEX[combAIndex] | MASK_BY_COMB_INDEX[combBIndex]),
-                  offset(((std::min(cmc,constants::NUM_CMC - 1) * constants::NUM_REQUIRED_A 
-                                  + std::min(devotionACount,constants::NUM_REQUIRED_A - 1)) * constants::NUM_REQUIRED_B
-                              + std::min(devotionBCount,constants::NUM_REQUIRED_B - 1)) << (3 * constants::COUNT_DIMS_EXP)) {
+                  offset(constants::prob_slab_offset(cmc, devotionACount, devotionBCount)) {
             if (devotionACount < devotionBCount) {
                 *this = ManaRequirements(combBIndex, devotionBCount, combAIndex, devotionACount, cmc);
+            } else {
+                prob_table.ensure_slab(offset);
             }
         }
 
@@ -118,6 +146,8 @@ namespace mtgdraftbots::details {
         constexpr ManaRequirements& operator=(ManaRequirements&&) noexcept = default;
         constexpr bool operator==(const ManaRequirements& other) const noexcept = default;
 
+        friend struct CostBuckets;
+
     private:
         LandsMask valid_lands_a{Mask::OFF};
         LandsMask valid_lands_b{Mask::OFF};
@@ -127,7 +157,7 @@ namespace mtgdraftbots::details {
 
     template<uint8_t n> requires (n > 2)
     struct ManaRequirements<n> {
-        constexpr auto calculate_probability(const Lands& lands) const noexcept -> float {
+        auto calculate_probability(const Lands& lands) const noexcept -> float {
             float result = 1;
             for (const ManaRequirements<1>& sub_requirement : sub_requirements) {
                 result *= sub_requirement.calculate_probability(lands);
@@ -135,8 +165,13 @@ namespace mtgdraftbots::details {
             return result;
         }
 
-        constexpr ManaRequirements(const std::array<std::pair<std::size_t, std::size_t>, n>& devotions,
-                                   std::size_t cmc) noexcept {
+        constexpr auto lands_classes() const noexcept -> LandsClasses {
+            LandsClasses result{ 0 };
+            for (std::size_t i = 0; i < sub_requirements.size(); i++) add_lands_class(result, sub_requirements[i].valid_lands, i);
+            return result;
+        }
+
+        ManaRequirements(const std::array<std::pair<std::size_t, std::size_t>, n>& devotions, std::size_t cmc) {
             LandsMask combined_mask{Mask::OFF};
             std::size_t total_devotion = 0;
             for (size_t i=0; i < n; i++) {
@@ -154,6 +189,8 @@ namespace mtgdraftbots::details {
         constexpr ManaRequirements& operator=(ManaRequirements&&) noexcept = default;
         constexpr bool operator==(const ManaRequirements& other) const noexcept = default;
 
+        friend struct CostBuckets;
+
     private:
         std::array<ManaRequirements<1>, n + 1> sub_requirements;
     };
@@ -162,12 +199,38 @@ namespace mtgdraftbots::details {
                                               ManaRequirements<2>, ManaRequirements<3>,
                                               ManaRequirements<4>, ManaRequirements<5>>;
 
+    // The colored part of a mana cost after parsing the symbols, this is small and trivially copyable so it can be
+    // stored directly in the params file and turned into a CardCost without parsing any strings.
+    struct PackedCost {
+        static constexpr std::size_t MAX_DEVOTIONS = 5;
+
+        std::uint8_t cmc;
+        std::uint8_t num_devotions;
+        std::array<std::uint8_t, MAX_DEVOTIONS> comb_indices;
+        std::array<std::uint8_t, MAX_DEVOTIONS> devotion_counts;
+
+        constexpr bool operator==(const PackedCost&) const noexcept = default;
+    };
+
+    // Whether get_requirement can turn cost into a requirement, it indexes MASK_BY_COMB_INDEX and the slabs of
+    // prob_table with the fields unchecked. Every cost pack_cost makes is valid, ones read from a file might not be.
+    constexpr bool valid_packed_cost(const PackedCost& cost) noexcept {
+        if (cost.cmc >= constants::NUM_CMC || cost.num_devotions > PackedCost::MAX_DEVOTIONS) return false;
+        for (std::size_t i = 0; i < cost.num_devotions; i++) {
+            if (cost.comb_indices[i] >= MASK_BY_COMB_INDEX.size()
+                || cost.devotion_counts[i] >= constants::NUM_REQUIRED_A) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     template <typename Container>
-    constexpr auto get_requirement(std::uint8_t cmc, const Container& symbols) noexcept -> RequirementVariant {
+    constexpr auto pack_cost(std::uint8_t cmc, const Container& symbols) noexcept -> PackedCost {
         using namespace constants;
         std::array<std::uint8_t, 32> devotion_index{255};
-        std::uint8_t devotion_count{0};
-        std::array<std::pair<std::uint8_t, std::uint8_t>, 5> devotions;
+        // The slabs stop at the last cmc and count, anything above reads the same probabilities as those.
+        PackedCost result{ static_cast<std::uint8_t>(std::min<std::size_t>(cmc, NUM_CMC - 1)), 0, { 0 }, { 0 } };
         for (const auto& symbol : symbols) {
             std::array<bool, 5> found_colors{false};
             bool found_any = false;
@@ -191,66 +254,89 @@ namespace mtgdraftbots::details {
                     std::find(std::begin(COLOR_COMBINATIONS), std::end(COLOR_COMBINATIONS), found_colors)
                 );
                 if (devotion_index[index] != 255) {
-                    devotions[devotion_count].first = index;
-                    devotions[devotion_count].second = 1;
-                    devotion_index[index] = devotion_count;
-                    devotion_count++;
-                } else {
-                    devotions[devotion_index[index]].second++;
+                    // Costs with more requirements than we can represent are treated as having none.
+                    if (result.num_devotions < PackedCost::MAX_DEVOTIONS) {
+                        result.comb_indices[result.num_devotions] = static_cast<std::uint8_t>(index);
+                        result.devotion_counts[result.num_devotions] = 1;
+                    }
+                    devotion_index[index] = result.num_devotions;
+                    result.num_devotions++;
+                } else if (devotion_index[index] < PackedCost::MAX_DEVOTIONS
+                           && result.devotion_counts[devotion_index[index]] < NUM_REQUIRED_A - 1) {
+                    result.devotion_counts[devotion_index[index]]++;
                 }
             }
         }
+        if (result.num_devotions > PackedCost::MAX_DEVOTIONS) return PackedCost{ result.cmc, 0, { 0 }, { 0 } };
+        return result;
+    }
+
+    inline auto get_requirement(const PackedCost& cost) -> RequirementVariant {
+        const auto& [cmc, devotion_count, combs, counts] = cost;
         switch (devotion_count) {
         case 1:
-            return ManaRequirements<1>{devotions[0].first, devotions[0].second, cmc};
+            return ManaRequirements<1>{combs[0], counts[0], cmc};
         case 2:
-            return ManaRequirements<2>{devotions[0].first, devotions[0].second,
-                                       devotions[1].first, devotions[1].second,
+            return ManaRequirements<2>{combs[0], counts[0],
+                                       combs[1], counts[1],
                                        cmc};
         case 3:
             return ManaRequirements<3>{std::array<std::pair<std::size_t, std::size_t>, 3>{{
-                                        {devotions[0].first, devotions[0].second},
-                                        {devotions[1].first, devotions[1].second},
-                                        {devotions[2].first, devotions[2].second},
+                                        {combs[0], counts[0]},
+                                        {combs[1], counts[1]},
+                                        {combs[2], counts[2]},
                                        }}, cmc};
         case 4:
             return ManaRequirements<4>{std::array<std::pair<std::size_t, std::size_t>, 4>{{
-                                        {devotions[0].first, devotions[0].second},
-                                        {devotions[1].first, devotions[1].second},
-                                        {devotions[2].first, devotions[2].second},
-                                        {devotions[3].first, devotions[3].second},
+                                        {combs[0], counts[0]},
+                                        {combs[1], counts[1]},
+                                        {combs[2], counts[2]},
+                                        {combs[3], counts[3]},
                                        }}, cmc};
         case 5:
             return ManaRequirements<5>{std::array<std::pair<std::size_t, std::size_t>, 5>{{
-                                        {devotions[0].first, devotions[0].second},
-                                        {devotions[1].first, devotions[1].second},
-                                        {devotions[2].first, devotions[2].second},
-                                        {devotions[3].first, devotions[3].second},
-                                        {devotions[4].first, devotions[4].second},
+                                        {combs[0], counts[0]},
+                                        {combs[1], counts[1]},
+                                        {combs[2], counts[2]},
+                                        {combs[3], counts[3]},
+                                        {combs[4], counts[4]},
                                        }}, cmc};
         }
         return ManaRequirements<0>();
     }
 
+    template <typename Container>
+    auto get_requirement(std::uint8_t cmc, const Container& symbols) -> RequirementVariant {
+        return get_requirement(pack_cost(cmc, symbols));
+    }
+
     struct CardCost : public RequirementVariant {
-        constexpr auto calculate_probability(const Lands& lands) const -> float {
+        auto calculate_probability(const Lands& lands) const -> float {
             return mpark::visit([&lands](const auto& requirement) { return requirement.calculate_probability(lands); },
                                 *this);
         }
 
+        constexpr auto lands_classes() const -> LandsClasses {
+            return mpark::visit([](const auto& requirement) { return requirement.lands_classes(); }, *this);
+        }
+
         constexpr CardCost() noexcept
                 : RequirementVariant(ManaRequirements<0>{})
         { }
 
-        constexpr CardCost(const CardDetails& card) noexcept
+        CardCost(const CardDetails& card)
                 : RequirementVariant(get_requirement(card.cmc, card.cost_symbols))
         { }
 
         template<typename Container>
-        constexpr CardCost(std::uint8_t cmc, const Container& symbols) noexcept
+        CardCost(std::uint8_t cmc, const Container& symbols)
                 : RequirementVariant(get_requirement(cmc, symbols))
         { }
 
+        explicit CardCost(const PackedCost& cost)
+                : RequirementVariant(get_requirement(cost))
+        { }
+
         using RequirementVariant::RequirementVariant;
         using RequirementVariant::operator=;
 
@@ -1,10 +1,24 @@
 #ifndef MTGDRAFTBOTS_CARDVALUES_HPP
 #define MTGDRAFTBOTS_CARDVALUES_HPP
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
 #include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include "mtgdraftbots/types.hpp"
 #include "mtgdraftbots/details/cardcost.hpp"
+#include "mtgdraftbots/details/cost_buckets.hpp"
 
 namespace mtgdraftbots::details {
     using Colors = std::array<bool, 5>;
@@ -16,52 +30,278 @@ namespace mtgdraftbots::details {
         std::uint8_t produces;
     };
 
-    inline static std::map<std::string, CardValue> card_lookups;
+    // Oracle ids are UUIDs so we store them as their 128 bits instead of as 36 character strings.
+    struct OracleId {
+        std::uint64_t high;
+        std::uint64_t low;
+
+        constexpr bool operator==(const OracleId&) const noexcept = default;
+    };
+
+    constexpr std::array<std::uint8_t, 256> HEX_DIGIT_VALUES = ([]() {
+        std::array<std::uint8_t, 256> result{ 0 };
+        for (auto& value : result) value = 0xFF;
+        for (std::uint8_t i = 0; i < 10; i++) result['0' + i] = i;
+        for (std::uint8_t i = 0; i < 6; i++) {
+            result['a' + i] = 10 + i;
+            result['A' + i] = 10 + i;
+        }
+        return result;
+    })();
+
+    constexpr auto parse_oracle_id(std::string_view oracle_id) noexcept -> std::optional<OracleId> {
+        if (oracle_id.size() != 36 || oracle_id[8] != '-' || oracle_id[13] != '-'
+            || oracle_id[18] != '-' || oracle_id[23] != '-') return std::nullopt;
+        constexpr std::array<std::uint8_t, 32> DIGIT_POSITIONS{ {
+             0,  1,  2,  3,  4,  5,  6,  7,  9, 10, 11, 12, 14, 15, 16, 17,
+            19, 20, 21, 22, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35,
+        } };
+        std::uint64_t high = 0;
+        std::uint64_t low = 0;
+        std::uint8_t invalid = 0;
+        for (std::size_t i = 0; i < 16; i++) {
+            const std::uint8_t high_digit = HEX_DIGIT_VALUES[static_cast<unsigned char>(oracle_id[DIGIT_POSITIONS[i]])];
+            const std::uint8_t low_digit = HEX_DIGIT_VALUES[static_cast<unsigned char>(oracle_id[DIGIT_POSITIONS[i + 16]])];
+            invalid |= high_digit | low_digit;
+            high = (high << 4) | high_digit;
+            low = (low << 4) | low_digit;
+        }
+        // Only invalid characters have the high bits set.
+        if (invalid & 0xF0) return std::nullopt;
+        return OracleId{ high, low };
+    }
+
+    inline auto format_oracle_id(const OracleId& oracle_id) -> std::string {
+        constexpr std::string_view HEX_DIGITS = "0123456789abcdef";
+        std::string result;
+        result.reserve(36);
+        for (std::size_t i = 0; i < 32; i++) {
+            if (i == 8 || i == 12 || i == 16 || i == 20) result.push_back('-');
+            const std::uint64_t half = i < 16 ? oracle_id.high : oracle_id.low;
+            result.push_back(HEX_DIGITS[(half >> (4 * (15 - i % 16))) & 0xF]);
+        }
+        return result;
+    }
+
+    // Interned table of every card in the params. Each card gets a dense id that indexes all of the columns.
+    // Cards are keyed by the parsed OracleId, so lookups ignore the case of the hex digits.
+    // The ids are found through a flat open addressing (linear probing) index so resolving an oracle id costs a
+    // single hash probe in the common case. The columns are only views so that they can point directly into a
+    // params file that is used in place, storage keeps whatever they point into alive.
+    struct CardTable {
+        static constexpr std::uint32_t NOT_FOUND = std::numeric_limits<std::uint32_t>::max();
+
+        auto find(const OracleId& oracle_id) const noexcept -> std::uint32_t {
+            if (slots.empty()) return NOT_FOUND;
+            const std::size_t mask = slots.size() - 1;
+            for (std::size_t slot = hash(oracle_id) & mask; slots[slot] != NOT_FOUND; slot = (slot + 1) & mask) {
+                if (oracle_ids[slots[slot]] == oracle_id) return slots[slot];
+            }
+            return NOT_FOUND;
+        }
+
+        auto find(std::string_view oracle_id) const noexcept -> std::uint32_t {
+            const std::optional<OracleId> parsed = parse_oracle_id(oracle_id);
+            if (!parsed) return NOT_FOUND;
+            return find(*parsed);
+        }
+
+        std::size_t size() const noexcept { return oracle_ids.size(); }
+
+        // UUIDs are mostly random bits already so a multiplicative mix is enough to spread them.
+        // This is part of the params file format since the index is stored in it.
+        static constexpr auto hash(const OracleId& oracle_id) noexcept -> std::uint32_t {
+            const std::uint64_t mixed = (oracle_id.high ^ (oracle_id.low * 0x9E3779B97F4A7C15ull)) * 0xBF58476D1CE4E5B9ull;
+            return static_cast<std::uint32_t>(mixed ^ (mixed >> 32));
+        }
+
+        std::span<const OracleId> oracle_ids;
+        std::span<const float> ratings;
+        std::span<const Embedding> embeddings;
+        std::span<const PackedCost> costs;
+        std::span<const std::uint8_t> produces;
+        // Power of two sized, NOT_FOUND marks an empty slot.
+        std::span<const std::uint32_t> slots;
+        std::shared_ptr<const void> storage;
+    };
+
+    // Owns the columns of a CardTable while it is being built up one card at a time.
+    struct CardTableBuilder {
+        // Returns false without modifying the table if the oracle id is already present.
+        bool insert(const OracleId& oracle_id, float rating, const Embedding& embedding, const PackedCost& cost,
+                    std::uint8_t card_produces) {
+            if (2 * (oracle_ids.size() + 1) > slots.size()) {
+                rehash(std::max<std::size_t>(64, 2 * slots.size()));
+            }
+            const std::size_t mask = slots.size() - 1;
+            std::size_t slot = CardTable::hash(oracle_id) & mask;
+            for (; slots[slot] != CardTable::NOT_FOUND; slot = (slot + 1) & mask) {
+                if (oracle_ids[slots[slot]] == oracle_id) return false;
+            }
+            slots[slot] = static_cast<std::uint32_t>(oracle_ids.size());
+            oracle_ids.push_back(oracle_id);
+            ratings.push_back(rating);
+            embeddings.push_back(embedding);
+            costs.push_back(cost);
+            produces.push_back(card_produces);
+            return true;
+        }
+
+        void reserve(std::size_t num_cards) {
+            oracle_ids.reserve(num_cards);
+            ratings.reserve(num_cards);
+            embeddings.reserve(num_cards);
+            costs.reserve(num_cards);
+            produces.reserve(num_cards);
+            if (2 * num_cards > slots.size()) rehash(std::bit_ceil(2 * num_cards));
+        }
+
+        auto build() && -> CardTable {
+            auto storage = std::make_shared<const CardTableBuilder>(std::move(*this));
+            return {
+                storage->oracle_ids, storage->ratings, storage->embeddings, storage->costs, storage->produces,
+                storage->slots, storage,
+            };
+        }
+
+        std::vector<OracleId> oracle_ids;
+        std::vector<float> ratings;
+        std::vector<Embedding> embeddings;
+        std::vector<PackedCost> costs;
+        std::vector<std::uint8_t> produces;
+        std::vector<std::uint32_t> slots;
+
+    private:
+        void rehash(std::size_t num_slots) {
+            slots.assign(num_slots, CardTable::NOT_FOUND);
+            const std::size_t mask = num_slots - 1;
+            for (std::size_t card_id = 0; card_id < oracle_ids.size(); card_id++) {
+                std::size_t slot = CardTable::hash(oracle_ids[card_id]) & mask;
+                while (slots[slot] != CardTable::NOT_FOUND) slot = (slot + 1) & mask;
+                slots[slot] = static_cast<std::uint32_t>(card_id);
+            }
+        }
+    };
+
+    inline static CardTable card_table;
+
+    struct PackedCostHash {
+        auto operator()(const PackedCost& cost) const noexcept -> std::size_t {
+            std::uint64_t result = cost.cmc | (std::uint64_t{ cost.num_devotions } << 8);
+            for (std::size_t i = 0; i < PackedCost::MAX_DEVOTIONS; i++) {
+                result = result * 0x100000001B3ULL ^ (cost.comb_indices[i] | (std::uint64_t{ cost.devotion_counts[i] } << 8));
+            }
+            return static_cast<std::size_t>(result ^ (result >> 29));
+        }
+    };
 
     struct CardValues {
-        // These can be either names or oracle_ids depending on the lookup table. card_lookups defaults to oracle_ids.
-        inline CardValues(const std::vector<std::string>& card_names, const std::map<std::string, CardValue> lookup) {
+        inline explicit CardValues(const std::vector<std::string>& card_oracle_ids, const CardTable& table) {
+            ratings.reserve(card_oracle_ids.size());
+            embeddings.reserve(card_oracle_ids.size());
+            normalized_embeddings.reserve(card_oracle_ids.size());
+            costs.reserve(card_oracle_ids.size());
+            cost_indices.reserve(card_oracle_ids.size());
+            produces.reserve(card_oracle_ids.size());
+            std::unordered_map<PackedCost, std::uint32_t, PackedCostHash> packed_cost_indices;
+            for (const std::string& oracle_id : card_oracle_ids) {
+                const std::uint32_t card_id = table.find(oracle_id);
+                if (card_id != CardTable::NOT_FOUND) {
+                    ratings.push_back(table.ratings[card_id]);
+                    embeddings.push_back(table.embeddings[card_id]);
+                    push_back_normalized(embeddings.back());
+                    const auto [iter, inserted] = packed_cost_indices.try_emplace(table.costs[card_id],
+                                                                                  static_cast<std::uint32_t>(unique_costs.size()));
+                    if (inserted) push_back_unique_cost(CardCost(table.costs[card_id]));
+                    costs.push_back(unique_costs[iter->second]);
+                    cost_indices.push_back(iter->second);
+                    produces.push_back(table.produces[card_id]);
+                }
+                else {
+                    push_back_unknown();
+                }
+            }
+        }
+
+        // This is for lookups by something other than oracle id, e.g. by name.
+        inline CardValues(const std::vector<std::string>& card_names, const std::map<std::string, CardValue>& lookup) {
             ratings.reserve(card_names.size());
             embeddings.reserve(card_names.size());
+            normalized_embeddings.reserve(card_names.size());
             costs.reserve(card_names.size());
+            produces.reserve(card_names.size());
             for (const std::string& name : card_names) {
                 auto iter = lookup.find(name);
-                if (iter != lookup.end()) {
-                    ratings.push_back(iter->second.rating);
-                    embeddings.push_back(iter->second.embedding);
-                    costs.push_back(iter->second.cost);
-                    produces.push_back(iter->second.produces);
-                }
-                else {
-                    ratings.push_back(0.5f);
-                    embeddings.push_back({ 0 });
-                    costs.push_back({});
-                    produces.push_back(32);
-                }
+                if (iter != lookup.end()) push_back(iter->second);
+                else push_back_unknown();
             }
         }
 
-        inline explicit CardValues(const std::vector<std::string>& card_names) 
-            : CardValues(card_names, card_lookups)
+        inline explicit CardValues(const std::vector<std::string>& card_oracle_ids)
+            : CardValues(card_oracle_ids, card_table)
         { }
 
         CardValues() = default;
 
-        void push_back(CardValue value) {
+        void push_back(const CardValue& value) {
             ratings.push_back(value.rating);
             embeddings.push_back(value.embedding);
-            costs.push_back(value.cost);
+            push_back_normalized(value.embedding);
+            push_back_cost(value.cost);
             produces.push_back(value.produces);
         }
 
+        void push_back_unknown() {
+            ratings.push_back(0.5f);
+            embeddings.push_back({ 0 });
+            normalized_embeddings.push_back({ 0 });
+            push_back_cost({});
+            produces.push_back(32);
+        }
+
         std::size_t size() const {
             return ratings.size();
         }
 
+        // Fills probs with the probability of every card's cost under lands, evaluating each distinct cost once.
+        void evaluate_costs(const Lands& lands, std::span<float> probs) const {
+            std::vector<float> unique_probs(unique_costs.size());
+            cost_buckets.evaluate(lands, unique_probs);
+            for (std::size_t i = 0; i < cost_indices.size(); i++) probs[i] = unique_probs[cost_indices[i]];
+        }
+
         std::vector<float> ratings;
         std::vector<Embedding> embeddings;
+        // The embeddings scaled to unit length, or all zeros for cards without one.
+        std::vector<Embedding> normalized_embeddings;
         std::vector<CardCost> costs;
         std::vector<std::uint8_t> produces;
+        // The distinct costs of the card list, costs[i] == unique_costs[cost_indices[i]]. Cubes have many cards
+        // sharing a cost, so anything evaluated per cost is done over these.
+        std::vector<CardCost> unique_costs;
+        std::vector<std::uint32_t> cost_indices;
+        // The unique costs grouped for evaluating them all against one Lands at once.
+        CostBuckets cost_buckets;
+
+    private:
+        // Costs that do not come from a CardTable have no PackedCost to hash, so they are matched by comparison.
+        void push_back_cost(const CardCost& cost) {
+            const auto iter = std::find(std::begin(unique_costs), std::end(unique_costs), cost);
+            const auto index = static_cast<std::uint32_t>(std::distance(std::begin(unique_costs), iter));
+            if (iter == std::end(unique_costs)) push_back_unique_cost(cost);
+            costs.push_back(unique_costs[index]);
+            cost_indices.push_back(index);
+        }
+
+        void push_back_unique_cost(const CardCost& cost) {
+            unique_costs.push_back(cost);
+            cost_buckets.push_back(cost);
+        }
+
+        void push_back_normalized(const Embedding& embedding) {
+            Embedding& normalized = normalized_embeddings.emplace_back(embedding);
+            l2_normalize(normalized);
+        }
     };
 }
 #endif
\ No newline at end of file
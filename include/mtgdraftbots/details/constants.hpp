@@ -1,5 +1,6 @@
 #ifndef MTGDRAFTBOTS_CONSTANTS_H
 #define MTGDRAFTBOTS_CONSTANTS_H
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstdint>
@@ -13,19 +14,33 @@
 #include <frozen/unordered_map.h>
 
 namespace mtgdraftbots::constants {
-    constexpr std::size_t COUNT_DIMS_EXP = 5;
-    // This is slightly misleading since these are actually 1 greater than the max value
-    // since they are the size of that dimension.
-    constexpr std::size_t NUM_COUNT_A  = 1 << COUNT_DIMS_EXP;
-    constexpr std::size_t NUM_COUNT_B  = 1 << COUNT_DIMS_EXP;
-    constexpr std::size_t NUM_COUNT_AB = 1 << COUNT_DIMS_EXP;
     constexpr std::size_t NUM_REQUIRED_B = 4;
     constexpr std::size_t NUM_REQUIRED_A = 7;
     constexpr std::size_t NUM_CMC = 9;
-    constexpr std::size_t PROB_TABLE_SIZE =  NUM_COUNT_A * NUM_COUNT_B * NUM_COUNT_AB
-                                           * NUM_REQUIRED_B * NUM_REQUIRED_A * NUM_CMC;
+    // The probabilities are for a 40 card deck with 17 lands, drawing an opening hand of 7 and then 1 card a turn.
+    constexpr std::size_t DECK_SIZE = 40;
+    constexpr std::size_t OPENING_HAND_SIZE = 7;
+    // The probability table in details/prob_table.hpp is indexed by the usable counts of those 17 lands, so each
+    // count dimension has NUM_USABLE values. Each (cmc, required a, required b) slab is PROB_SLAB_SIZE entries
+    // indexed by a + b * NUM_USABLE + ab * NUM_USABLE * NUM_USABLE, small enough that the lookups of a hill climb
+    // stay in cache.
+    constexpr std::uint32_t MAX_USABLE = 17;
+    constexpr std::size_t NUM_USABLE = MAX_USABLE + 1;
+    constexpr std::size_t PROB_SLAB_SIZE = NUM_USABLE * NUM_USABLE * NUM_USABLE;
+    constexpr std::size_t NUM_PROB_SLABS = NUM_REQUIRED_B * NUM_REQUIRED_A * NUM_CMC;
+    constexpr std::size_t PROB_TABLE_SIZE = NUM_PROB_SLABS * PROB_SLAB_SIZE;
+    // Probabilities are stored as 16 bit fixed point.
+    constexpr float PROB_SCALE = 65535.f;
 
-#include "mtgdraftbots/generated/prob_table.hpp"
+    constexpr auto prob_slab_offset(std::size_t cmc, std::size_t required_a, std::size_t required_b) noexcept -> std::size_t {
+        return ((std::min(cmc, NUM_CMC - 1) * NUM_REQUIRED_A + std::min(required_a, NUM_REQUIRED_A - 1)) * NUM_REQUIRED_B
+                + std::min(required_b, NUM_REQUIRED_B - 1)) * PROB_SLAB_SIZE;
+    }
+
+    constexpr auto prob_index(std::size_t slab_offset, std::uint32_t usable_a, std::uint32_t usable_b = 0,
+                              std::uint32_t usable_ab = 0) noexcept -> std::size_t {
+        return slab_offset + usable_a + usable_b * NUM_USABLE + usable_ab * NUM_USABLE * NUM_USABLE;
+    }
 
     constexpr auto COLOR_TO_INDEX = frozen::make_unordered_map<char, std::uint8_t>({
         {'W', 0},
@@ -0,0 +1,318 @@
+#ifndef MTGDRAFTBOTS_DETAILS_COST_BUCKETS_HPP
+#define MTGDRAFTBOTS_DETAILS_COST_BUCKETS_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <mpark/variant.hpp>
+#ifdef USE_VECTORCLASS
+#include <vectorclass.h>
+#endif
+
+#include "mtgdraftbots/details/cardcost.hpp"
+#include "mtgdraftbots/details/constants.hpp"
+#include "mtgdraftbots/details/dispatch.hpp"
+#include "mtgdraftbots/details/prob_table.hpp"
+#include "mtgdraftbots/details/simd.hpp"
+
+namespace mtgdraftbots::details {
+    constexpr auto mask_bits(const LandsMask& mask) noexcept -> std::uint32_t {
+        std::uint32_t result = 0;
+        for (std::size_t i = 0; i < mask.size(); i++) {
+            if (mask[i] == Mask::ON) result |= 1u << i;
+        }
+        return result;
+    }
+
+    constexpr auto hash_combine(std::uint64_t seed, std::uint64_t value) noexcept -> std::uint64_t {
+        std::uint64_t x = seed ^ (value + 0x9E3779B97F4A7C15ULL + (seed << 6) + (seed >> 2));
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    // Sums of a Lands over each 4 bit slice of a mask, so the usable count for any mask is 8 table lookups.
+    struct SliceSums {
+        constexpr explicit SliceSums(const Lands& lands) noexcept {
+            for (std::size_t slice = 0; slice < sums.size(); slice++) {
+                for (std::size_t slice_mask = 1; slice_mask < 16; slice_mask++) {
+                    const std::size_t lowest = static_cast<std::size_t>(std::countr_zero(slice_mask));
+                    sums[slice][slice_mask] = sums[slice][slice_mask & (slice_mask - 1)] + lands[4 * slice + lowest];
+                }
+            }
+        }
+
+        constexpr auto usable(std::uint32_t mask) const noexcept -> std::uint32_t {
+            std::uint32_t result = 0;
+            for (std::size_t slice = 0; slice < sums.size(); slice++) result += sums[slice][(mask >> (4 * slice)) & 0xF];
+            return result;
+        }
+
+        std::array<std::array<std::uint32_t, 16>, 8> sums{ {{ 0 }} };
+    };
+
+    // The requirements of a list of card costs grouped by arity, each group stored as struct of arrays so a Lands
+    // can be evaluated against a whole group without visiting the variant per card. Every requirement is a product
+    // of factors that each are a single lookup into prob_table. ManaRequirements<1> has one factor with one mask,
+    // ManaRequirements<2> one factor with three masks (a, b, ab), and ManaRequirements<n> for n > 2 has its n + 1
+    // single mask sub requirements as factors.
+    //
+    // All masks are combinations of MASK_BY_COMB_INDEX so a card list only has a few dozen distinct ones. They are
+    // stored once and referred to by id, evaluating a Lands first projects it to the usable count of every distinct
+    // mask after which each factor is just indexing.
+    struct CostBuckets {
+        struct Bucket {
+            std::size_t masks_per_factor;
+            std::size_t num_factors;
+            // Position of each requirement in the list of costs.
+            std::vector<std::uint32_t> cards;
+            // Mask ids indexed by factor * masks_per_factor + mask, then by requirement.
+            std::vector<std::vector<std::uint32_t>> masks;
+            // Indexed by factor, then by requirement.
+            std::vector<std::vector<std::uint32_t>> offsets;
+        };
+
+        static constexpr std::size_t MAX_ARITY = 5;
+
+        CostBuckets() {
+            buckets[0] = make_bucket(1, 1);
+            buckets[1] = make_bucket(3, 1);
+            for (std::size_t arity = 3; arity <= MAX_ARITY; arity++) buckets[arity - 1] = make_bucket(1, arity + 1);
+        }
+
+        explicit CostBuckets(std::span<const CardCost> costs) : CostBuckets() {
+            for (const CardCost& cost : costs) push_back(cost);
+        }
+
+        void push_back(const CardCost& cost) {
+            const auto position = static_cast<std::uint32_t>(locations.size());
+            mpark::visit([&](const auto& requirement) { add(requirement, position); }, cost);
+        }
+
+        std::size_t size() const noexcept { return locations.size(); }
+
+        // The distinct masks as bitsets of land combinations, indexed by mask id.
+        auto masks() const noexcept -> const std::vector<std::uint32_t>& { return distinct_masks; }
+
+        // Writes the usable count of every distinct mask under lands to usable.
+        MTGDRAFTBOTS_TARGET_CLONES
+        void project(const Lands& lands, std::span<std::uint32_t> usable) const noexcept {
+            const SliceSums sums(lands);
+            for (std::size_t i = 0; i < distinct_masks.size(); i++) {
+                usable[i] = std::min(sums.usable(distinct_masks[i]), constants::MAX_USABLE);
+            }
+        }
+
+        // Writes the probability of every cost, in the order they were added, to probs.
+        void evaluate(const Lands& lands, std::span<float> probs) const {
+            std::vector<std::uint32_t> usable(distinct_masks.size());
+            project(lands, usable);
+            evaluate_projected(usable, probs);
+        }
+
+        void evaluate_projected(std::span<const std::uint32_t> usable, std::span<float> probs) const noexcept {
+#ifdef USE_VECTORCLASS
+            for (std::uint32_t card : trivial_cards) probs[card] = 1.f;
+            for (std::size_t arity = 1; arity <= MAX_ARITY; arity++) evaluate_vcl(buckets[arity - 1], usable, probs);
+#else
+            evaluate_projected_scalar(usable, probs);
+#endif
+        }
+
+        // Always the scalar loops, the reference the vectorclass path is checked against.
+        void evaluate_projected_scalar(std::span<const std::uint32_t> usable, std::span<float> probs) const noexcept {
+            for (std::uint32_t card : trivial_cards) probs[card] = 1.f;
+            for (std::size_t arity = 1; arity <= MAX_ARITY; arity++) evaluate_scalar(arity, buckets[arity - 1], usable, probs);
+        }
+
+        // Appends the arity of the cost at position followed by the offset and masks of each of its factors to key,
+        // which is everything its probability is computed from, so the same cost on different cards, or in different
+        // card lists, appends the same values. Returns false, appending nothing, for costs without requirements.
+        bool append_cost_key(std::size_t position, std::vector<std::uint32_t>& key) const {
+            const auto [arity, row] = locations[position];
+            if (arity == 0) return false;
+            const Bucket& bucket = buckets[arity - 1];
+            key.push_back(arity);
+            for (std::size_t factor = 0; factor < bucket.num_factors; factor++) {
+                key.push_back(bucket.offsets[factor][row]);
+                for (std::size_t i = 0; i < bucket.masks_per_factor; i++) {
+                    key.push_back(distinct_masks[bucket.masks[factor * bucket.masks_per_factor + i][row]]);
+                }
+            }
+            return true;
+        }
+
+        // The probability of the single cost at position given the projection of some Lands.
+        auto probability(std::size_t position, std::span<const std::uint32_t> usable) const noexcept -> float {
+            using namespace constants;
+            const auto [arity, row] = locations[position];
+            if (arity == 0) return 1.f;
+            const Bucket& bucket = buckets[arity - 1];
+            float prob = 1.f;
+            for (std::size_t factor = 0; factor < bucket.num_factors; factor++) {
+                const std::size_t first_mask = factor * bucket.masks_per_factor;
+                std::uint32_t usable_b = 0;
+                std::uint32_t usable_ab = 0;
+                if (bucket.masks_per_factor == 3) {
+                    usable_b = usable[bucket.masks[first_mask + 1][row]];
+                    usable_ab = usable[bucket.masks[first_mask + 2][row]];
+                }
+                prob *= prob_table[prob_index(bucket.offsets[factor][row], usable[bucket.masks[first_mask][row]], usable_b, usable_ab)];
+            }
+            return prob;
+        }
+
+    private:
+        static auto make_bucket(std::size_t masks_per_factor, std::size_t num_factors) -> Bucket {
+            return { masks_per_factor, num_factors, {},
+                     std::vector<std::vector<std::uint32_t>>(masks_per_factor * num_factors),
+                     std::vector<std::vector<std::uint32_t>>(num_factors) };
+        }
+
+        auto mask_id(const LandsMask& mask) -> std::uint32_t {
+            const std::uint32_t bits = mask_bits(mask);
+            auto iter = std::find(std::begin(distinct_masks), std::end(distinct_masks), bits);
+            if (iter != std::end(distinct_masks)) return static_cast<std::uint32_t>(std::distance(std::begin(distinct_masks), iter));
+            distinct_masks.push_back(bits);
+            return static_cast<std::uint32_t>(distinct_masks.size() - 1);
+        }
+
+        void add(const ManaRequirements<0>&, std::uint32_t position) {
+            trivial_cards.push_back(position);
+            locations.push_back({ 0, 0 });
+        }
+
+        void add(const ManaRequirements<1>& requirement, std::uint32_t position) {
+            Bucket& bucket = buckets[0];
+            locations.push_back({ 1, static_cast<std::uint32_t>(bucket.cards.size()) });
+            bucket.cards.push_back(position);
+            bucket.masks[0].push_back(mask_id(requirement.valid_lands));
+            bucket.offsets[0].push_back(static_cast<std::uint32_t>(requirement.offset));
+        }
+
+        void add(const ManaRequirements<2>& requirement, std::uint32_t position) {
+            Bucket& bucket = buckets[1];
+            locations.push_back({ 2, static_cast<std::uint32_t>(bucket.cards.size()) });
+            bucket.cards.push_back(position);
+            bucket.masks[0].push_back(mask_id(requirement.valid_lands_a));
+            bucket.masks[1].push_back(mask_id(requirement.valid_lands_b));
+            bucket.masks[2].push_back(mask_id(requirement.valid_lands_ab));
+            bucket.offsets[0].push_back(static_cast<std::uint32_t>(requirement.offset));
+        }
+
+        template <std::uint8_t n> requires (n > 2)
+        void add(const ManaRequirements<n>& requirement, std::uint32_t position) {
+            Bucket& bucket = buckets[n - 1];
+            locations.push_back({ n, static_cast<std::uint32_t>(bucket.cards.size()) });
+            bucket.cards.push_back(position);
+            for (std::size_t i = 0; i < requirement.sub_requirements.size(); i++) {
+                bucket.masks[i].push_back(mask_id(requirement.sub_requirements[i].valid_lands));
+                bucket.offsets[i].push_back(static_cast<std::uint32_t>(requirement.sub_requirements[i].offset));
+            }
+        }
+
+        template <std::size_t masks_per_factor, std::size_t num_factors>
+        static void evaluate_scalar(const Bucket& bucket, std::span<const std::uint32_t> usable, std::span<float> probs) noexcept {
+            using namespace constants;
+            std::array<const std::uint32_t*, masks_per_factor * num_factors> masks;
+            std::array<const std::uint32_t*, num_factors> offsets;
+            for (std::size_t i = 0; i < masks.size(); i++) masks[i] = bucket.masks[i].data();
+            for (std::size_t i = 0; i < offsets.size(); i++) offsets[i] = bucket.offsets[i].data();
+            for (std::size_t i = 0; i < bucket.cards.size(); i++) {
+                float prob = 1.f;
+                for (std::size_t factor = 0; factor < num_factors; factor++) {
+                    std::size_t index;
+                    if constexpr (masks_per_factor == 1) {
+                        index = prob_index(offsets[factor][i], usable[masks[factor][i]]);
+                    } else {
+                        const std::size_t first_mask = factor * masks_per_factor;
+                        index = prob_index(offsets[factor][i], usable[masks[first_mask][i]], usable[masks[first_mask + 1][i]],
+                                           usable[masks[first_mask + 2][i]]);
+                    }
+                    prob *= prob_table[index];
+                }
+                probs[bucket.cards[i]] = prob;
+            }
+        }
+
+        MTGDRAFTBOTS_TARGET_CLONES
+        static void evaluate_scalar(std::size_t arity, const Bucket& bucket, std::span<const std::uint32_t> usable,
+                                    std::span<float> probs) noexcept {
+            switch (arity) {
+            case 1: return evaluate_scalar<1, 1>(bucket, usable, probs);
+            case 2: return evaluate_scalar<3, 1>(bucket, usable, probs);
+            case 3: return evaluate_scalar<1, 4>(bucket, usable, probs);
+            case 4: return evaluate_scalar<1, 5>(bucket, usable, probs);
+            case 5: return evaluate_scalar<1, 6>(bucket, usable, probs);
+            }
+        }
+
+#ifdef USE_VECTORCLASS
+#if INSTRSET >= 9
+        using IndexVec = vcl::Vec16ui;
+        using ProbVec = vcl::Vec16f;
+#else
+        using IndexVec = vcl::Vec8ui;
+        using ProbVec = vcl::Vec8f;
+#endif
+        static constexpr std::size_t LANES = IndexVec::size();
+
+        static auto usable_vcl(std::span<const std::uint32_t> usable, const std::uint32_t* mask_ids, int count) noexcept -> IndexVec {
+            IndexVec ids;
+            ids.load_partial(count, mask_ids);
+            return IndexVec(vcl::lookup<std::numeric_limits<int>::max()>(ids, reinterpret_cast<const int*>(usable.data())));
+        }
+
+        // There is no 16 bit gather, so this gathers the 32 bit words holding each entry and picks the half it is in.
+        static auto lookup_prob_vcl(IndexVec index) noexcept -> ProbVec {
+            using namespace constants;
+            const IndexVec words(vcl::lookup<static_cast<int>(PROB_TABLE_SIZE / 2)>(
+                index >> 1, reinterpret_cast<const int*>(prob_table.data())));
+            const IndexVec values = vcl::select((index & IndexVec(1)) != IndexVec(0), words >> 16, words & IndexVec(0xFFFF));
+            return vcl::to_float(values) * ProbVec(1.f / PROB_SCALE);
+        }
+
+        static void evaluate_vcl(const Bucket& bucket, std::span<const std::uint32_t> usable, std::span<float> probs) noexcept {
+            using namespace constants;
+            const IndexVec stride_b(static_cast<std::uint32_t>(NUM_USABLE));
+            const IndexVec stride_ab(static_cast<std::uint32_t>(NUM_USABLE * NUM_USABLE));
+            std::array<float, LANES> block_probs;
+            for (std::size_t start = 0; start < bucket.cards.size(); start += LANES) {
+                const int count = static_cast<int>(std::min(LANES, bucket.cards.size() - start));
+                ProbVec prob(1.f);
+                for (std::size_t factor = 0; factor < bucket.num_factors; factor++) {
+                    IndexVec index;
+                    index.load_partial(count, bucket.offsets[factor].data() + start);
+                    if (bucket.masks_per_factor == 1) {
+                        index = index + usable_vcl(usable, bucket.masks[factor].data() + start, count);
+                    } else {
+                        const std::size_t first_mask = factor * bucket.masks_per_factor;
+                        index = index + usable_vcl(usable, bucket.masks[first_mask].data() + start, count)
+                                      + usable_vcl(usable, bucket.masks[first_mask + 1].data() + start, count) * stride_b
+                                      + usable_vcl(usable, bucket.masks[first_mask + 2].data() + start, count) * stride_ab;
+                    }
+                    prob *= lookup_prob_vcl(index);
+                }
+                prob.store(block_probs.data());
+                for (int i = 0; i < count; i++) probs[bucket.cards[start + i]] = block_probs[i];
+            }
+        }
+#endif
+
+        struct Location {
+            std::uint32_t arity;
+            std::uint32_t row;
+        };
+
+        std::vector<Location> locations;
+        std::vector<std::uint32_t> trivial_cards;
+        std::vector<std::uint32_t> distinct_masks;
+        std::array<Bucket, MAX_ARITY> buckets;
+    };
+}
+#endif
@@ -0,0 +1,60 @@
+#ifndef MTGDRAFTBOTS_DETAILS_DISPATCH_HPP
+#define MTGDRAFTBOTS_DETAILS_DISPATCH_HPP
+
+#include <string_view>
+
+// USE_VECTORCLASS builds are tied to the instruction set they are compiled for. Portable builds can instead define
+// MTGDRAFTBOTS_RUNTIME_DISPATCH, which compiles each hot loop marked with MTGDRAFTBOTS_TARGET_CLONES once per
+// instruction set below. The loader then binds every one of them to the best variant the CPU supports, through an
+// ifunc resolver, before the first call.
+#if defined(MTGDRAFTBOTS_RUNTIME_DISPATCH) && !defined(USE_VECTORCLASS) && defined(__GNUC__) && defined(__x86_64__) \
+    && defined(__ELF__)
+#define MTGDRAFTBOTS_HAS_TARGET_CLONES
+#define MTGDRAFTBOTS_TARGET_CLONES __attribute__((target_clones("default", "sse4.2", "avx2", "avx512f")))
+#else
+#define MTGDRAFTBOTS_TARGET_CLONES
+#endif
+
+// WebAssembly builds compiled with -msimd128 get their own backend, the JS side loads that module only where the
+// runtime supports SIMD128.
+#if !defined(USE_VECTORCLASS) && defined(__wasm_simd128__)
+#define MTGDRAFTBOTS_WASM_SIMD
+#endif
+
+#ifdef USE_VECTORCLASS
+#include <vectorclass.h>
+#endif
+
+namespace mtgdraftbots::details {
+    enum struct InstructionSet {
+        BASELINE, SSE4_2, AVX2, AVX512, WASM_SIMD128
+    };
+
+    // The instruction set the SIMD paths run with on this machine.
+    inline auto active_instruction_set() noexcept -> InstructionSet {
+#if defined(MTGDRAFTBOTS_HAS_TARGET_CLONES)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return InstructionSet::AVX512;
+        if (__builtin_cpu_supports("avx2")) return InstructionSet::AVX2;
+        if (__builtin_cpu_supports("sse4.2")) return InstructionSet::SSE4_2;
+#elif defined(MTGDRAFTBOTS_WASM_SIMD)
+        return InstructionSet::WASM_SIMD128;
+#elif defined(USE_VECTORCLASS)
+        if constexpr (INSTRSET >= 9) return InstructionSet::AVX512;
+        else if constexpr (INSTRSET >= 8) return InstructionSet::AVX2;
+        else if constexpr (INSTRSET >= 6) return InstructionSet::SSE4_2;
+#endif
+        return InstructionSet::BASELINE;
+    }
+
+    constexpr auto instruction_set_name(InstructionSet instruction_set) noexcept -> std::string_view {
+        switch (instruction_set) {
+        case InstructionSet::SSE4_2: return "SSE4.2";
+        case InstructionSet::AVX2: return "AVX2";
+        case InstructionSet::AVX512: return "AVX-512";
+        case InstructionSet::WASM_SIMD128: return "WebAssembly SIMD128";
+        default: return "baseline";
+        }
+    }
+}
+#endif
@@ -3,11 +3,13 @@
 
 #include <algorithm>
 #include <cstdint>
-#include <numeric>
+#include <limits>
 #include <random>
+#include <vector>
 
 #include "mtgdraftbots/types.hpp"
 #include "mtgdraftbots/details/cardvalues.hpp"
+#include "mtgdraftbots/details/probs_cache.hpp"
 
 namespace mtgdraftbots::details {
     template<std::uint_fast32_t N, std::enable_if_t<(N == 4), std::nullptr_t> = nullptr>
@@ -77,7 +79,19 @@ namespace mtgdraftbots::details {
         return result;
     }
 
-    using ScoreValue = std::tuple<float, std::vector<float>, Lands>;
+    // Whether lands is something get_random_lands could have returned for available_lands.
+    constexpr bool is_valid_start(const Lands& lands, const Lands& available_lands) noexcept {
+        unsigned int total_available = 0;
+        unsigned int total = 0;
+        for (std::size_t i = 0; i < lands.size(); i++) {
+            if (lands[i] > available_lands[i]) return false;
+            total_available += available_lands[i];
+            total += lands[i];
+        }
+        if (total_available < 17) return lands == available_lands;
+        return total == 17;
+    }
+
     static constexpr std::array<LandsMask, 5> masks{
             MASK_BY_COMB_INDEX[1],
             MASK_BY_COMB_INDEX[2],
@@ -86,62 +100,201 @@ namespace mtgdraftbots::details {
             MASK_BY_COMB_INDEX[5],
     };
 
-    void evaluate_option(const DrafterState& drafter_state, const Lands& new_lands, ScoreValue& current_score,
-                         const CardValues& cards, std::int8_t min_diff) {
-        std::vector<std::pair<float, float>> probs_excluding_trivial(std::get<1>(current_score).size());
-        const auto transformation = [&new_lands](const mtgdraftbots::details::CardCost& cost) -> std::pair<float, float> {
-            const float prob = cost.calculate_probability(new_lands);
-            if (CardCost() == cost) return { 0.f, prob };
-            else return { prob, prob };
-        };
-        std::transform(cards.costs.begin(), cards.costs.end(), std::begin(probs_excluding_trivial), transformation);
-        float max_in_pack_prob = std::reduce(std::begin(drafter_state.cards_in_pack),
-            std::end(drafter_state.cards_in_pack),
-            0.f, [&](auto a, auto b) { return std::max(a, probs_excluding_trivial[b].first); });
-        float sum_picked_prob = std::reduce(std::begin(drafter_state.picked),
-            std::end(drafter_state.picked),
-            0.f, [&](auto a, auto b) { return a + probs_excluding_trivial[b].first; });
-        float mean_seen_prob = std::reduce(std::begin(drafter_state.seen),
-            std::end(drafter_state.seen),
-            0.f, [&](auto a, auto b) { return a + probs_excluding_trivial[b].first; }) / drafter_state.seen.size();
-        float new_score = sum_picked_prob + 3 * mean_seen_prob + 5 * max_in_pack_prob + min_diff / 17.f;
-        if (new_score > std::get<float>(current_score)) {
-            std::get<0>(current_score) = new_score;
-            std::transform(probs_excluding_trivial.begin(), probs_excluding_trivial.end(), std::get<1>(current_score).begin(),
-                           [](auto a) { return a.second; });
-            std::get<Lands>(current_score) = new_lands;
+    // Land combinations closer than this, summed over how many lands produce each color, are not searched.
+    constexpr std::int8_t MIN_LANDS_DIFFERENCE = 12;
+
+    constexpr auto lands_difference(const Lands& lands1, const Lands& lands2) noexcept -> std::int8_t {
+        std::int8_t difference = 0;
+        for (const LandsMask& mask : masks) {
+            difference += static_cast<std::int8_t>(std::abs(sum_masked(mask, lands1) - sum_masked(mask, lands2)));
         }
+        return difference;
     }
 
-    std::pair<std::vector<std::array<float, NUM_LAND_COMBS>>, std::array<Lands, NUM_LAND_COMBS>> generate_probs(
-            const DrafterState& drafter_state, const CardValues& cards) {
+    struct GenerateProbsStats {
+        std::size_t evaluations{ 0 };
+        // Land combinations whose climb started from the warm start lands.
+        std::size_t warm_started{ 0 };
+        // Land combinations that had a warm start but had to start from random lands anyway.
+        std::size_t random_restarts{ 0 };
+    };
+
+    // Scores land combinations by how castable the picked, seen and in pack cards are. Only cards with a colored
+    // requirement can change the score, and moving lands between two combinations only changes the probability of
+    // the cards whose masks tell them apart, so candidates are scored as a delta from a base land combination.
+    //
+    // Cards sharing a cost always have the same probability, so the state is kept per unique cost with how many
+    // times it was picked and seen, and the picked sum and seen mean become sums weighted by those counts.
+    struct DeltaEvaluator {
+        DeltaEvaluator(const DrafterState& drafter_state, const CardValues& cards_) : cards(cards_) {
+            std::vector<std::size_t> relevant_index(cards.unique_costs.size(), NOT_RELEVANT);
+            const auto add = [&](std::size_t card_idx) -> std::size_t {
+                const std::size_t idx = cards.cost_indices[card_idx];
+                if (relevant_index[idx] == NOT_RELEVANT) {
+                    if (CardCost() == cards.unique_costs[idx]) return NOT_RELEVANT;
+                    relevant_index[idx] = indices.size();
+                    indices.push_back(idx);
+                    relevant_costs.push_back(cards.unique_costs[idx]);
+                    classes.push_back(cards.unique_costs[idx].lands_classes());
+                    picked_counts.push_back(0.f);
+                    seen_counts.push_back(0.f);
+                    in_pack.push_back(0);
+                    base_probs.push_back(0.f);
+                }
+                return relevant_index[idx];
+            };
+            for (std::size_t idx : drafter_state.cards_in_pack) {
+                const std::size_t relevant = add(idx);
+                if (relevant != NOT_RELEVANT) in_pack[relevant] = 1;
+            }
+            for (std::size_t idx : drafter_state.picked) {
+                const std::size_t relevant = add(idx);
+                if (relevant != NOT_RELEVANT) picked_counts[relevant] += 1.f;
+            }
+            for (std::size_t idx : drafter_state.seen) {
+                const std::size_t relevant = add(idx);
+                if (relevant != NOT_RELEVANT) seen_counts[relevant] += 1.f;
+            }
+            num_seen = static_cast<float>(drafter_state.seen.size());
+            const std::vector<std::uint32_t>& masks = relevant_costs.masks();
+            base_usable.resize(masks.size());
+            usable.resize(masks.size());
+            for (std::size_t bit = 0; bit < mask_members.size(); bit++) {
+                for (std::size_t m = 0; m < masks.size(); m++) {
+                    if ((masks[m] >> bit) & 1) mask_members[bit].push_back(static_cast<std::uint32_t>(m));
+                }
+            }
+        }
+
+        // Fully evaluates lands and makes them the base for evaluate, returning their score.
+        inline auto set_base(const Lands& lands) noexcept -> float {
+            base_picked = 0.f;
+            base_seen = 0.f;
+            float max_in_pack_prob = 0.f;
+            base_lands = lands;
+            relevant_costs.project(lands, base_usable);
+            relevant_costs.evaluate_projected(base_usable, base_probs);
+            usable = base_usable;
+            for (std::size_t i = 0; i < indices.size(); i++) {
+                const float prob = base_probs[i];
+                base_picked += picked_counts[i] * prob;
+                base_seen += seen_counts[i] * prob;
+                if (in_pack[i]) max_in_pack_prob = std::max(max_in_pack_prob, prob);
+            }
+            return score(base_picked, base_seen, max_in_pack_prob);
+        }
+
+        // new_lands must only differ from the base lands in increase and decrease. Moving lands between two
+        // combinations only changes the usable count of the distinct masks containing exactly one of them, so the
+        // projection of the base is patched instead of recomputed.
+        MTGDRAFTBOTS_TARGET_CLONES
+        inline auto evaluate(const Lands& new_lands, std::uint8_t increase, std::uint8_t decrease) noexcept -> float {
+            const std::uint32_t amount = new_lands[increase] - base_lands[increase];
+            for (std::uint32_t m : mask_members[increase]) usable[m] = base_usable[m] + amount;
+            for (std::uint32_t m : mask_members[decrease]) usable[m] = base_usable[m] - amount;
+            for (std::uint32_t m : mask_members[increase]) {
+                if ((relevant_costs.masks()[m] >> decrease) & 1) usable[m] = base_usable[m];
+            }
+            float sum_picked = base_picked;
+            float sum_seen = base_seen;
+            float max_in_pack_prob = 0.f;
+            for (std::size_t i = 0; i < indices.size(); i++) {
+                float prob = base_probs[i];
+                if (classes[i][increase] != classes[i][decrease]) {
+                    prob = relevant_costs.probability(i, usable);
+                    sum_picked += picked_counts[i] * (prob - base_probs[i]);
+                    sum_seen += seen_counts[i] * (prob - base_probs[i]);
+                }
+                if (in_pack[i]) max_in_pack_prob = std::max(max_in_pack_prob, prob);
+            }
+            for (std::uint32_t m : mask_members[increase]) usable[m] = base_usable[m];
+            for (std::uint32_t m : mask_members[decrease]) usable[m] = base_usable[m];
+            return score(sum_picked, sum_seen, max_in_pack_prob);
+        }
+
+    private:
+        static constexpr std::size_t NOT_RELEVANT = std::numeric_limits<std::size_t>::max();
+
+        constexpr auto score(float sum_picked_prob, float sum_seen_prob, float max_in_pack_prob) const noexcept -> float {
+            return sum_picked_prob + 3 * (sum_seen_prob / num_seen) + 5 * max_in_pack_prob;
+        }
+
+        const CardValues& cards;
+        // Parallel arrays over the relevant unique costs, indices are into cards.unique_costs.
+        std::vector<std::size_t> indices;
+        CostBuckets relevant_costs;
+        std::vector<LandsClasses> classes;
+        std::vector<float> picked_counts;
+        std::vector<float> seen_counts;
+        std::vector<std::uint8_t> in_pack;
+        std::vector<float> base_probs;
+        // The distinct masks of relevant_costs containing each land combination.
+        std::array<std::vector<std::uint32_t>, 32> mask_members;
+        Lands base_lands{ 0 };
+        std::vector<std::uint32_t> base_usable;
+        // Scratch for the patched projection of the lands being evaluated.
+        std::vector<std::uint32_t> usable;
+        float num_seen{ 0.f };
+        float base_picked{ 0.f };
+        float base_seen{ 0.f };
+    };
+
+    // The probability of every card in the list under each of the land combinations.
+    inline auto get_probs(std::size_t num_cards, const CardValues& cards, const std::array<Lands, NUM_LAND_COMBS>& lands)
+            -> std::vector<std::array<float, NUM_LAND_COMBS>> {
+        std::vector<std::array<float, NUM_LAND_COMBS>> result(num_cards);
+        std::vector<float> unique_probs(cards.unique_costs.size());
+        for (std::size_t i = 0; i < NUM_LAND_COMBS; i++) {
+            cards.cost_buckets.evaluate(lands[i], unique_probs);
+            for (std::size_t j = 0; j < num_cards; j++) result[j][i] = unique_probs[cards.cost_indices[j]];
+        }
+        return result;
+    }
+
+    // available_lands must match get_available_lands(drafter_state, cards), callers that track it as cards are
+    // picked can pass it in directly.
+    //
+    // warm_start, usually the lands found for the previous pick of the same drafter, seeds the climbs since the best
+    // land combinations barely move between picks. A climb falls back to random lands when its warm start is no
+    // longer valid for available_lands or has collapsed onto a land combination already found in this call, which
+    // the climb could not move away from.
+    inline std::pair<std::vector<std::array<float, NUM_LAND_COMBS>>, std::array<Lands, NUM_LAND_COMBS>> generate_probs(
+            const DrafterState& drafter_state, const CardValues& cards, const Lands& available_lands,
+            const std::array<Lands, NUM_LAND_COMBS>* warm_start = nullptr, GenerateProbsStats* stats = nullptr) {
         Rand rng{drafter_state.seed};
-        std::vector<std::array<float, NUM_LAND_COMBS>> result(drafter_state.card_oracle_ids.size());
         std::array<Lands, NUM_LAND_COMBS> result_lands;
         std::array<std::array<std::uint8_t, 5>, NUM_LAND_COMBS> found_values{ {{ 0 }} };
-        const mtgdraftbots::Lands available_lands = get_available_lands(drafter_state, cards);
+        GenerateProbsStats local_stats;
+        DeltaEvaluator evaluator(drafter_state, cards);
         for (std::size_t i = 0; i < NUM_LAND_COMBS; i++) {
-            ScoreValue prev_score{ -1.f, std::vector<float>(drafter_state.card_oracle_ids.size(), 0.f), get_random_lands(available_lands, rng) };
-            ScoreValue current_score = prev_score;
-            evaluate_option(drafter_state, std::get<Lands>(prev_score), current_score, cards, 0);
-            while (std::get<float>(prev_score) < std::get<float>(current_score)) {
+            bool use_warm_start = warm_start != nullptr && is_valid_start((*warm_start)[i], available_lands);
+            for (std::size_t j = 0; j < i && use_warm_start; j++) {
+                use_warm_start = lands_difference(result_lands[j], (*warm_start)[i]) >= MIN_LANDS_DIFFERENCE;
+            }
+            if (use_warm_start) local_stats.warm_started++;
+            else if (warm_start != nullptr) local_stats.random_restarts++;
+            Lands current_lands = use_warm_start ? (*warm_start)[i] : get_random_lands(available_lands, rng);
+            float prev_score = -1.f;
+            local_stats.evaluations++;
+            float current_score = evaluator.set_base(current_lands);
+            while (prev_score < current_score) {
                 prev_score = current_score;
+                const Lands prev_lands = current_lands;
                 for (std::uint8_t increase = 1; increase < 32; increase++) {
-					std::uint8_t max_increase = available_lands[increase] - std::get<mtgdraftbots::Lands>(prev_score)[increase];
+					std::uint8_t max_increase = available_lands[increase] - prev_lands[increase];
                     if (max_increase <= 0) continue;
                     for (std::uint8_t decrease = 0; decrease < 32; decrease++) {
                         if (decrease == increase) continue;
-						std::uint8_t max_amount = std::min(max_increase, std::get<mtgdraftbots::Lands>(prev_score)[decrease]);
+						std::uint8_t max_amount = std::min(max_increase, prev_lands[decrease]);
 						if (max_amount <= 0) continue;
-                        mtgdraftbots::Lands new_lands = std::get<mtgdraftbots::Lands>(prev_score);
+                        mtgdraftbots::Lands new_lands = prev_lands;
 						std::int8_t min_diff = 0;
                         for (std::uint8_t amount = 0; amount < max_amount; amount++) {
 							min_diff = 120;
 							new_lands[increase]++;
 							new_lands[decrease]--;
 
-							std::transform(std::begin(masks), std::end(masks), std::begin(found_values[i]),
-								[&new_lands](const mtgdraftbots::details::LandsMask& mask) { return mtgdraftbots::details::sum_masked(mask, new_lands); });
+							sum_masked(masks, new_lands, found_values[i]);
 							for (std::size_t j = 0; j < i; j++) {
 								std::int8_t difference = 0;
 								for (std::size_t k = 0; k < found_values[i].size(); k++) {
@@ -149,19 +302,39 @@ namespace mtgdraftbots::details {
 								}
 								min_diff = std::min(min_diff, difference);
 							}
-							if (min_diff >= 12) break;
+							if (min_diff >= MIN_LANDS_DIFFERENCE) break;
 						}
-                        if (min_diff < 12) continue;
-                        evaluate_option(drafter_state, new_lands, current_score, cards, min_diff);
+                        if (min_diff < MIN_LANDS_DIFFERENCE) continue;
+                        local_stats.evaluations++;
+                        const float new_score = evaluator.evaluate(new_lands, increase, decrease) + min_diff / 17.f;
+                        if (new_score > current_score) {
+                            current_score = new_score;
+                            current_lands = new_lands;
+                        }
                     }
                 }
+                if (current_lands != prev_lands) evaluator.set_base(current_lands);
             }
-            for (std::size_t j = 0; j < drafter_state.card_oracle_ids.size(); j++) {
-                result[j][i] = std::get<1>(current_score)[j];
-            }
-            result_lands[i] = std::get<Lands>(current_score);
+            result_lands[i] = current_lands;
         }
-        return { std::move(result), result_lands };
+        if (stats != nullptr) *stats = local_stats;
+        return { get_probs(drafter_state.card_oracle_ids.size(), cards, result_lands), result_lands };
+    }
+
+    // Without a warm start the land combinations only depend on the probs_key, so they are looked up in
+    // generate_probs_cache first.
+    inline std::pair<std::vector<std::array<float, NUM_LAND_COMBS>>, std::array<Lands, NUM_LAND_COMBS>> generate_probs(
+            const DrafterState& drafter_state, const CardValues& cards) {
+        const Lands available_lands = get_available_lands(drafter_state, cards);
+        if (generate_probs_cache.capacity() == 0) return generate_probs(drafter_state, cards, available_lands);
+        ProbsKey key = probs_key(drafter_state, cards, available_lands);
+        std::array<Lands, NUM_LAND_COMBS> lands;
+        if (generate_probs_cache.find(key, lands)) {
+            return { get_probs(drafter_state.card_oracle_ids.size(), cards, lands), lands };
+        }
+        auto result = generate_probs(drafter_state, cards, available_lands);
+        generate_probs_cache.insert(std::move(key), result.second);
+        return result;
     }
 }
 #endif
\ No newline at end of file
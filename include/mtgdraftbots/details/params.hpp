@@ -0,0 +1,312 @@
+#ifndef MTGDRAFTBOTS_DETAILS_PARAMS_HPP
+#define MTGDRAFTBOTS_DETAILS_PARAMS_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__)
+#define MTGDRAFTBOTS_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "mtgdraftbots/oracles.hpp"
+#include "mtgdraftbots/types.hpp"
+#include "mtgdraftbots/details/cardcost.hpp"
+#include "mtgdraftbots/details/cardvalues.hpp"
+
+namespace mtgdraftbots::details {
+    // Versioned params format. Everything after the header is a section of one column of values, struct of arrays
+    // style, with every section starting on a PARAMS_ALIGNMENT boundary from the start of the file. That lets the
+    // whole file be mapped (or copied once) and used in place without parsing anything. All values are little endian.
+    constexpr std::array<char, 8> PARAMS_MAGIC{ 'M', 'T', 'G', 'D', 'B', 'P', 'R', 'M' };
+    constexpr std::uint32_t PARAMS_VERSION = 2;
+    constexpr std::size_t PARAMS_ALIGNMENT = 64;
+    constexpr std::size_t ORACLE_TITLE_SIZE = 64;
+
+    struct ParamsSection {
+        std::uint64_t offset;
+        std::uint64_t size;
+    };
+
+    struct ParamsHeader {
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        std::uint32_t header_size;
+        std::uint32_t num_oracles;
+        std::uint32_t num_cards;
+        std::uint32_t num_slots;
+        std::uint32_t reserved;
+        ParamsSection embedding_bias; // Embedding
+        ParamsSection oracle_weights; // Weights per oracle
+        ParamsSection oracle_titles;  // ORACLE_TITLE_SIZE null padded characters per oracle
+        ParamsSection oracle_ids;     // OracleId per card
+        ParamsSection ratings;        // float per card
+        ParamsSection embeddings;     // Embedding per card
+        ParamsSection costs;          // PackedCost per card
+        ParamsSection produces;       // uint8_t per card
+        ParamsSection slots;          // uint32_t per slot of the CardTable index
+    };
+
+    static_assert(std::is_trivially_copyable_v<ParamsHeader> && std::is_trivially_copyable_v<PackedCost>
+                  && std::is_trivially_copyable_v<OracleId> && std::is_trivially_copyable_v<Weights>);
+    static_assert(sizeof(PackedCost) == 12 && sizeof(OracleId) == 16 && sizeof(ParamsHeader) == 176);
+
+    inline bool is_versioned_params(std::span<const char> buffer) noexcept {
+        return buffer.size() >= sizeof(PARAMS_MAGIC)
+            && std::equal(std::begin(PARAMS_MAGIC), std::end(PARAMS_MAGIC), buffer.data());
+    }
+
+    // count is 64 bit so sizes computed from 32 bit header fields cannot wrap around on 32 bit targets.
+    template <typename T>
+    auto get_params_section(std::span<const char> buffer, const ParamsSection& section,
+                            std::uint64_t count) noexcept -> std::optional<std::span<const T>> {
+        if (count > std::numeric_limits<std::size_t>::max() / sizeof(T)) return std::nullopt;
+        if (section.offset % PARAMS_ALIGNMENT != 0 || section.size != count * sizeof(T)
+            || section.offset > buffer.size() || section.size > buffer.size() - section.offset) return std::nullopt;
+        const char* start = buffer.data() + section.offset;
+        if (reinterpret_cast<std::uintptr_t>(start) % alignof(T) != 0) return std::nullopt;
+        return std::span<const T>(reinterpret_cast<const T*>(start), static_cast<std::size_t>(count));
+    }
+
+    // CardTable::find probes until it reaches an empty slot and indexes oracle_ids with whatever it finds on the way,
+    // so every slot has to be empty or a valid card id and exactly num_cards of them can be in use.
+    inline bool valid_card_index(std::span<const std::uint32_t> slots, std::size_t num_cards) noexcept {
+        std::size_t num_used = 0;
+        for (std::uint32_t slot : slots) {
+            if (slot == CardTable::NOT_FOUND) continue;
+            if (slot >= num_cards) return false;
+            num_used++;
+        }
+        return num_used == num_cards;
+    }
+
+    // The buffer has to stay valid for as long as these params are loaded, storage is kept alive until then.
+    inline bool load_versioned_params(std::span<const char> buffer, std::shared_ptr<const void> storage) {
+        if constexpr (std::endian::native != std::endian::little) {
+            std::cerr << "The versioned params format can only be used in place on little endian machines." << std::endl;
+            return false;
+        }
+        ParamsHeader header;
+        if (!is_versioned_params(buffer) || buffer.size() < sizeof(header)) {
+            std::cerr << "Params buffer is too small or is missing the header." << std::endl;
+            return false;
+        }
+        std::memcpy(&header, buffer.data(), sizeof(header));
+        if (header.version != PARAMS_VERSION || header.header_size != sizeof(header)) {
+            std::cerr << "Unsupported params version " << header.version << '.' << std::endl;
+            return false;
+        }
+        if (!std::has_single_bit(header.num_slots) || header.num_slots < 2 * std::uint64_t{ header.num_cards }) {
+            std::cerr << "Params had an invalid card index size." << std::endl;
+            return false;
+        }
+        const auto bias = get_params_section<Embedding>(buffer, header.embedding_bias, 1);
+        const auto weights = get_params_section<Weights>(buffer, header.oracle_weights, header.num_oracles);
+        const auto titles = get_params_section<char>(buffer, header.oracle_titles,
+                                                         std::uint64_t{ header.num_oracles } * ORACLE_TITLE_SIZE);
+        const auto oracle_ids = get_params_section<OracleId>(buffer, header.oracle_ids, header.num_cards);
+        const auto ratings = get_params_section<float>(buffer, header.ratings, header.num_cards);
+        const auto embeddings = get_params_section<Embedding>(buffer, header.embeddings, header.num_cards);
+        const auto costs = get_params_section<PackedCost>(buffer, header.costs, header.num_cards);
+        const auto produces = get_params_section<std::uint8_t>(buffer, header.produces, header.num_cards);
+        const auto slots = get_params_section<std::uint32_t>(buffer, header.slots, header.num_slots);
+        if (!bias || !weights || !titles || !oracle_ids || !ratings || !embeddings || !costs || !produces || !slots) {
+            std::cerr << "Params had a section that was out of bounds or misaligned." << std::endl;
+            return false;
+        }
+        if (!valid_card_index(*slots, header.num_cards)) {
+            std::cerr << "Params had a card index that does not match its cards." << std::endl;
+            return false;
+        }
+        if (!std::all_of(costs->begin(), costs->end(), valid_packed_cost)) {
+            std::cerr << "Params had a card cost that is out of range." << std::endl;
+            return false;
+        }
+        embedding_bias = (*bias)[0];
+        weights_map.clear();
+        for (std::size_t i = 0; i < header.num_oracles; i++) {
+            const char* title = titles->data() + i * ORACLE_TITLE_SIZE;
+            weights_map.insert({ std::string(title, std::find(title, title + ORACLE_TITLE_SIZE, '\0')), (*weights)[i] });
+        }
+        card_table = CardTable{ *oracle_ids, *ratings, *embeddings, *costs, *produces, *slots, std::move(storage) };
+        return true;
+    }
+
+    template <typename T>
+    T read_unaligned(const char*& cur_pos) noexcept {
+        T result;
+        std::memcpy(&result, cur_pos, sizeof(T));
+        cur_pos += sizeof(T);
+        return result;
+    }
+
+    // The original format, a packed stream of fields that has to be parsed one at a time. Every read is checked
+    // against the end of the buffer first, and nothing is replaced unless the whole buffer parsed.
+    inline bool load_legacy_params(std::span<const char> buffer) {
+        const char* cur_pos = buffer.data();
+        const char* const end = buffer.data() + buffer.size();
+        const auto can_read = [&](std::size_t size) {
+            if (static_cast<std::size_t>(end - cur_pos) >= size) return true;
+            std::cerr << "Params buffer ended before all the cards were read." << std::endl;
+            return false;
+        };
+        // Titles are null terminated, without a terminator before the end they cannot be read.
+        const auto can_read_title = [&]() { return can_read(static_cast<std::size_t>(std::find(cur_pos, end, '\0') - cur_pos) + 1); };
+        Embedding bias;
+        if (!can_read(sizeof(bias) + sizeof(std::uint8_t))) return false;
+        for (std::size_t i = 0; i < bias.size(); i++) {
+            bias[i] = read_unaligned<float>(cur_pos);
+        }
+        std::uint8_t num_oracles = read_unaligned<std::uint8_t>(cur_pos);
+        std::map<std::string, Weights, std::less<>> new_weights_map;
+        for (std::size_t i = 0; i < num_oracles; i++) {
+            Weights weights;
+            if (!can_read(sizeof(weights))) return false;
+            for (std::size_t x = 0; x < WEIGHT_X_DIM; x++) {
+                for (std::size_t y = 0; y < WEIGHT_Y_DIM; y++) {
+                    weights[x][y] = read_unaligned<float>(cur_pos);
+                }
+            }
+            if (!can_read_title()) return false;
+            std::size_t length = std::strlen(cur_pos);
+            std::string title(cur_pos, cur_pos + length);
+            cur_pos += length + 1;
+            new_weights_map.insert({ title, weights });
+        }
+        // WASM is 32 bit by default, but this is saved as 64.
+        if (!can_read(sizeof(std::uint32_t))) return false;
+        std::uint32_t num_cards = read_unaligned<std::uint32_t>(cur_pos);
+        // Every card takes at least this many bytes, so a corrupt count cannot make reserve allocate far more than
+        // the buffer could hold.
+        constexpr std::size_t MIN_CARD_SIZE = sizeof(float) + sizeof(Embedding) + 3 * sizeof(std::uint8_t) + 36;
+        CardTableBuilder builder;
+        builder.reserve(std::min<std::size_t>(num_cards, static_cast<std::size_t>(end - cur_pos) / MIN_CARD_SIZE));
+        std::size_t num_dropped = 0;
+        for (std::size_t i = 0; i < num_cards; i++) {
+            if (!can_read(MIN_CARD_SIZE - 36)) return false;
+            float rating = read_unaligned<float>(cur_pos);
+            Embedding embedding;
+            for (std::size_t j = 0; j < embedding.size(); j++) {
+                embedding[j] = read_unaligned<float>(cur_pos);
+            }
+            std::uint8_t produces = read_unaligned<std::uint8_t>(cur_pos);
+            std::uint8_t cmc = read_unaligned<std::uint8_t>(cur_pos);
+            std::uint8_t num_symbols = read_unaligned<std::uint8_t>(cur_pos);
+            if (!can_read(3 * std::size_t{ num_symbols } + 36)) return false;
+            std::vector<std::string> symbols;
+            symbols.reserve(num_symbols);
+            for (std::size_t j = 0; j < num_symbols; j++) {
+                symbols.emplace_back(cur_pos, cur_pos + 3);
+                cur_pos += 3;
+            }
+            // They're UUID's so 36 is always the length. The card table is keyed by the parsed UUID, so entries
+            // whose key is not one can never be looked up and are dropped.
+            const std::optional<OracleId> oracle_id = parse_oracle_id({ cur_pos, 36 });
+            cur_pos += 36;
+            if (oracle_id) builder.insert(*oracle_id, rating, embedding, pack_cost(cmc, symbols), produces);
+            else num_dropped++;
+        }
+        if (num_dropped > 0) {
+            std::cerr << "Dropped " << num_dropped << " params entries whose key is not an oracle id, those cards will be"
+                      << " unrecognized." << std::endl;
+        }
+        embedding_bias = bias;
+        weights_map = std::move(new_weights_map);
+        card_table = std::move(builder).build();
+        return true;
+    }
+
+    inline bool load_params(std::span<const char> buffer, std::shared_ptr<const void> storage) {
+        if (is_versioned_params(buffer)) return load_versioned_params(buffer, std::move(storage));
+        else return load_legacy_params(buffer);
+    }
+
+    // Writes the currently loaded params in the versioned format.
+    inline auto serialize_params() -> std::vector<char> {
+        ParamsHeader header{ PARAMS_MAGIC, PARAMS_VERSION, sizeof(ParamsHeader),
+                             static_cast<std::uint32_t>(weights_map.size()), static_cast<std::uint32_t>(card_table.size()),
+                             static_cast<std::uint32_t>(card_table.slots.size()), 0, {}, {}, {}, {}, {}, {}, {}, {}, {} };
+        std::uint64_t end = sizeof(ParamsHeader);
+        const auto add_section = [&end](ParamsSection& section, std::size_t size) {
+            section.offset = (end + PARAMS_ALIGNMENT - 1) / PARAMS_ALIGNMENT * PARAMS_ALIGNMENT;
+            section.size = size;
+            end = section.offset + size;
+        };
+        add_section(header.embedding_bias, sizeof(Embedding));
+        add_section(header.oracle_weights, header.num_oracles * sizeof(Weights));
+        add_section(header.oracle_titles, header.num_oracles * ORACLE_TITLE_SIZE);
+        add_section(header.oracle_ids, card_table.oracle_ids.size_bytes());
+        add_section(header.ratings, card_table.ratings.size_bytes());
+        add_section(header.embeddings, card_table.embeddings.size_bytes());
+        add_section(header.costs, card_table.costs.size_bytes());
+        add_section(header.produces, card_table.produces.size_bytes());
+        add_section(header.slots, card_table.slots.size_bytes());
+        std::vector<char> result(end, '\0');
+        std::memcpy(result.data(), &header, sizeof(header));
+        std::memcpy(result.data() + header.embedding_bias.offset, embedding_bias.data(), sizeof(Embedding));
+        std::size_t oracle_index = 0;
+        for (const auto& [title, weights] : weights_map) {
+            std::memcpy(result.data() + header.oracle_weights.offset + oracle_index * sizeof(Weights), &weights, sizeof(Weights));
+            std::memcpy(result.data() + header.oracle_titles.offset + oracle_index * ORACLE_TITLE_SIZE, title.data(),
+                        std::min(title.size(), ORACLE_TITLE_SIZE - 1));
+            oracle_index++;
+        }
+        const auto write_column = [&result](const ParamsSection& section, const auto& column) {
+            if (!column.empty()) std::memcpy(result.data() + section.offset, column.data(), column.size_bytes());
+        };
+        write_column(header.oracle_ids, card_table.oracle_ids);
+        write_column(header.ratings, card_table.ratings);
+        write_column(header.embeddings, card_table.embeddings);
+        write_column(header.costs, card_table.costs);
+        write_column(header.produces, card_table.produces);
+        write_column(header.slots, card_table.slots);
+        return result;
+    }
+
+    // Maps the file read only and shared where that is supported so every process using the same params shares
+    // the pages, otherwise it is read into memory. Returns an empty span on failure.
+    inline auto map_params_file(const std::string& path) -> std::pair<std::span<const char>, std::shared_ptr<const void>> {
+#ifdef MTGDRAFTBOTS_HAS_MMAP
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return {};
+        struct stat file_stats;
+        if (::fstat(fd, &file_stats) != 0 || file_stats.st_size <= 0) {
+            ::close(fd);
+            return {};
+        }
+        const std::size_t size = static_cast<std::size_t>(file_stats.st_size);
+        void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) return {};
+        std::shared_ptr<const void> storage(mapped, [size](const void* ptr) { ::munmap(const_cast<void*>(ptr), size); });
+        return { std::span<const char>(static_cast<const char*>(mapped), size), std::move(storage) };
+#else
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) return {};
+        auto buffer = std::make_shared<std::vector<char>>(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0);
+        if (!file.read(buffer->data(), buffer->size())) return {};
+        return { std::span<const char>(*buffer), std::move(buffer) };
+#endif
+    }
+}
+#endif
@@ -0,0 +1,279 @@
+#ifndef MTGDRAFTBOTS_DETAILS_PROB_TABLE_HPP
+#define MTGDRAFTBOTS_DETAILS_PROB_TABLE_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <span>
+#include <vector>
+
+#if !defined(__EMSCRIPTEN__)
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#endif
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+#include <thread>
+#endif
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#include <sys/mman.h>
+#endif
+
+#include "mtgdraftbots/details/constants.hpp"
+
+namespace mtgdraftbots::details {
+    // The largest deck draw_probability takes, so other deck sizes can be compared with the table's model.
+    constexpr std::size_t MAX_DECK_SIZE = 60;
+
+    // Every binomial coefficient up to MAX_DECK_SIZE. They are exact as doubles for decks of up to 56 cards.
+    constexpr auto BINOMIALS = []() {
+        std::array<std::array<double, MAX_DECK_SIZE + 1>, MAX_DECK_SIZE + 1> result{ {{ 0 }} };
+        for (std::size_t n = 0; n < result.size(); n++) {
+            result[n][0] = 1;
+            for (std::size_t k = 1; k <= n; k++) result[n][k] = result[n - 1][k - 1] + result[n - 1][k];
+        }
+        return result;
+    }();
+
+    // The probability of having drawn the sources to pay required_a and required_b among num_drawn cards of a
+    // deck_size card deck. usable_a lands only pay for a, usable_b lands only for b and the rest of the usable_ab lands
+    // for either. This is a sum over the multivariate hypergeometric distribution of the lands drawn.
+    inline auto draw_probability(std::size_t deck_size, std::size_t num_drawn, std::size_t required_a,
+                                 std::size_t required_b, std::size_t usable_a, std::size_t usable_b,
+                                 std::size_t usable_ab) noexcept -> double {
+        const std::size_t usable_either = usable_ab > usable_a + usable_b ? usable_ab - usable_a - usable_b : 0;
+        const std::size_t other = deck_size - usable_a - usable_b - usable_either;
+        double ways = 0;
+        for (std::size_t drawn_a = 0; drawn_a <= std::min(usable_a, num_drawn); drawn_a++) {
+            const std::size_t missing_a = required_a > drawn_a ? required_a - drawn_a : 0;
+            for (std::size_t drawn_b = 0; drawn_b <= std::min(usable_b, num_drawn - drawn_a); drawn_b++) {
+                const std::size_t missing_b = required_b > drawn_b ? required_b - drawn_b : 0;
+                const std::size_t remaining = num_drawn - drawn_a - drawn_b;
+                double either_ways = 0;
+                for (std::size_t drawn_either = missing_a + missing_b; drawn_either <= std::min(usable_either, remaining);
+                     drawn_either++) {
+                    either_ways += BINOMIALS[usable_either][drawn_either] * BINOMIALS[other][remaining - drawn_either];
+                }
+                ways += BINOMIALS[usable_a][drawn_a] * BINOMIALS[usable_b][drawn_b] * either_ways;
+            }
+        }
+        return ways / BINOMIALS[deck_size][num_drawn];
+    }
+
+    // The model the table is filled from: a DECK_SIZE card deck on the play, so by turn cmc OPENING_HAND_SIZE + cmc - 1
+    // cards have been drawn.
+    inline auto cast_probability(std::size_t cmc, std::size_t required_a, std::size_t required_b, std::size_t usable_a,
+                                 std::size_t usable_b, std::size_t usable_ab) noexcept -> double {
+        using namespace constants;
+        return draw_probability(DECK_SIZE, OPENING_HAND_SIZE + std::max<std::size_t>(cmc, 1) - 1, required_a, required_b,
+                                usable_a, usable_b, usable_ab);
+    }
+
+#if !defined(__EMSCRIPTEN__)
+    // The trained probability table written as a file load reads, MTGDRAFTBOTS_PROB_TABLE in the environment
+    // overrides the path the build set with MTGDRAFTBOTS_PROB_TABLE_PATH. The wasm builds have no file system, the
+    // worker passes the file's contents to load instead.
+    inline auto default_prob_table_path() -> std::string {
+        if (const char* path = std::getenv("MTGDRAFTBOTS_PROB_TABLE"); path != nullptr) return path;
+#if defined(MTGDRAFTBOTS_PROB_TABLE_PATH)
+        return MTGDRAFTBOTS_PROB_TABLE_PATH;
+#else
+        return {};
+#endif
+    }
+#endif
+
+    // The chance of paying for every cmc, requirement and usable counts of at most MAX_USABLE, stored as 16 bit fixed
+    // point and laid out so the usable counts are the innermost dimensions of each slab (see constants::prob_index).
+    // The trained table is loaded the first time any slab is needed. Only the slabs it does not fill, all of them if
+    // it is missing, are computed by cast_probability, a slab at a time the first time a ManaRequirements needing
+    // that slab is constructed. Anything else indexing the table has to call ensure_slab first. On Linux it is backed
+    // by transparent huge pages so the whole table needs 2 TLB entries.
+    struct ProbTable {
+        ProbTable() : values(allocate()) { }
+
+        ProbTable(const ProbTable&) = delete;
+        ProbTable& operator=(const ProbTable&) = delete;
+
+        ~ProbTable() { std::free(values); }
+
+        // Safe to call from multiple threads, the slab is filled once and visible to every caller when this returns. The
+        // trained table is loaded before the first slab would be generated.
+        void ensure_slab(std::size_t slab_offset) {
+            load_trained();
+            const std::size_t slab = slab_offset / constants::PROB_SLAB_SIZE;
+            std::call_once(filled[slab], [&]() { fill_slab(slab); });
+        }
+
+        // Fills every slab that is not filled yet, spread over num_threads where threads are available.
+        void ensure_all(std::size_t num_threads = 1) {
+            std::atomic<std::size_t> next_slab{ 0 };
+            const auto worker = [&]() {
+                for (std::size_t slab = next_slab++; slab < constants::NUM_PROB_SLABS; slab = next_slab++) {
+                    ensure_slab(slab * constants::PROB_SLAB_SIZE);
+                }
+            };
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+            static_cast<void>(num_threads);
+            worker();
+#else
+            num_threads = std::clamp<std::size_t>(num_threads, 1, constants::NUM_PROB_SLABS);
+            std::vector<std::jthread> workers;
+            workers.reserve(num_threads - 1);
+            for (std::size_t i = 1; i < num_threads; i++) workers.emplace_back(worker);
+            worker();
+#endif
+        }
+
+        // Fills the slabs not filled yet from the contents of a file written by save. Returns false, leaving the table
+        // as it was, if the bytes were written for a different table.
+        bool load(std::span<const char> bytes) {
+            constexpr std::size_t FILE_SIZE = sizeof(FileHeader) + constants::PROB_TABLE_SIZE * sizeof(std::uint16_t);
+            FileHeader header;
+            if (bytes.size() != FILE_SIZE) return false;
+            std::memcpy(&header, bytes.data(), sizeof(header));
+            if (header.magic != FILE_MAGIC || header.version != FILE_VERSION
+                || header.num_entries != constants::PROB_TABLE_SIZE) {
+                return false;
+            }
+            const char* loaded = bytes.data() + sizeof(header);
+            for (std::size_t slab = 0; slab < constants::NUM_PROB_SLABS; slab++) {
+                std::call_once(filled[slab], [&]() {
+                    std::memcpy(values + slab * constants::PROB_SLAB_SIZE,
+                                loaded + slab * constants::PROB_SLAB_SIZE * sizeof(std::uint16_t),
+                                constants::PROB_SLAB_SIZE * sizeof(std::uint16_t));
+                });
+            }
+            return true;
+        }
+
+        // Loads the trained table from default_prob_table_path the first time it is called, every slab it fills is
+        // then never generated. Prints a warning once if there is a path but it cannot be loaded from.
+        void load_trained() {
+#if !defined(__EMSCRIPTEN__)
+            std::call_once(trained_loaded, [this]() {
+                const std::string path = default_prob_table_path();
+                if (!path.empty() && !load(path)) {
+                    std::cerr << "Could not read the trained probability table " << path
+                              << ", the probabilities are generated by cast_probability instead." << std::endl;
+                }
+            });
+#endif
+        }
+
+#if !defined(__EMSCRIPTEN__)
+        // Like load for the contents of the file at path, false if it cannot be read.
+        bool load(const std::string& path) {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if (!file) return false;
+            std::vector<char> bytes(static_cast<std::size_t>(file.tellg()));
+            file.seekg(0);
+            if (!file.read(bytes.data(), static_cast<std::streamsize>(bytes.size()))) return false;
+            return load(std::span<const char>(bytes));
+        }
+
+        // Fills every slab and writes the table to path.
+        bool save(const std::string& path, std::size_t num_threads = 1) {
+            ensure_all(num_threads);
+            return write(path, values);
+        }
+
+        // Writes a whole table in the layout of this one, e.g. one made outside of cast_probability, as a file load
+        // reads. It is written next to path first and renamed into place so a concurrent load never sees a partial
+        // file.
+        static bool write(const std::string& path, const std::uint16_t* source) {
+            const std::string temp_path = path + ".tmp";
+            {
+                std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+                const FileHeader header{ FILE_MAGIC, FILE_VERSION, static_cast<std::uint32_t>(constants::PROB_TABLE_SIZE) };
+                file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                file.write(reinterpret_cast<const char*>(source),
+                           static_cast<std::streamsize>(constants::PROB_TABLE_SIZE * sizeof(std::uint16_t)));
+                if (!file.flush()) {
+                    std::remove(temp_path.c_str());
+                    return false;
+                }
+            }
+            return std::rename(temp_path.c_str(), path.c_str()) == 0;
+        }
+#endif
+
+        // Overwrites every slab with source, which is in the layout of this table. Nothing may read the table
+        // meanwhile, and generate_probs_cache has to be cleared after since its entries were found with the old
+        // probabilities.
+        void assign(const std::uint16_t* source) {
+            for (std::once_flag& flag : filled) std::call_once(flag, []() { });
+            std::copy_n(source, constants::PROB_TABLE_SIZE, values);
+        }
+
+        auto operator[](std::size_t index) const noexcept -> float { return decode(values[index]); }
+
+        auto data() const noexcept -> const std::uint16_t* { return values; }
+
+        static constexpr auto encode(double prob) noexcept -> std::uint16_t {
+            return static_cast<std::uint16_t>(std::clamp(prob, 0., 1.) * constants::PROB_SCALE + 0.5);
+        }
+
+        static constexpr auto decode(std::uint16_t value) noexcept -> float {
+            return static_cast<float>(value) * (1.f / constants::PROB_SCALE);
+        }
+
+    private:
+        // Bump FILE_VERSION whenever cast_probability or the layout changes so stale caches are regenerated.
+        static constexpr std::array<char, 8> FILE_MAGIC{ 'M', 'T', 'G', 'D', 'B', 'P', 'R', 'B' };
+        static constexpr std::uint32_t FILE_VERSION = 1;
+
+        struct FileHeader {
+            std::array<char, 8> magic;
+            std::uint32_t version;
+            std::uint32_t num_entries;
+        };
+
+        void fill_slab(std::size_t slab) noexcept {
+            using namespace constants;
+            const std::size_t cmc = slab / (NUM_REQUIRED_A * NUM_REQUIRED_B);
+            const std::size_t required_a = slab / NUM_REQUIRED_B % NUM_REQUIRED_A;
+            const std::size_t required_b = slab % NUM_REQUIRED_B;
+            for (std::uint32_t usable_ab = 0; usable_ab < NUM_USABLE; usable_ab++) {
+                for (std::uint32_t usable_b = 0; usable_b < NUM_USABLE; usable_b++) {
+                    for (std::uint32_t usable_a = 0; usable_a < NUM_USABLE; usable_a++) {
+                        values[prob_index(slab * PROB_SLAB_SIZE, usable_a, usable_b, usable_ab)]
+                            = encode(cast_probability(cmc, required_a, required_b, usable_a, usable_b, usable_ab));
+                    }
+                }
+            }
+        }
+
+        static auto allocate() -> std::uint16_t* {
+            constexpr std::size_t bytes = constants::PROB_TABLE_SIZE * sizeof(std::uint16_t);
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+            constexpr std::size_t HUGE_PAGE_SIZE = std::size_t{ 1 } << 21;
+            constexpr std::size_t rounded_bytes = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+            void* result = std::aligned_alloc(HUGE_PAGE_SIZE, rounded_bytes);
+            // Only a hint, without transparent huge pages this is the same as any other allocation.
+            if (result != nullptr) madvise(result, rounded_bytes, MADV_HUGEPAGE);
+#else
+            void* result = std::malloc(bytes);
+#endif
+            if (result == nullptr) throw std::bad_alloc();
+            return static_cast<std::uint16_t*>(result);
+        }
+
+        std::uint16_t* values;
+        std::array<std::once_flag, constants::NUM_PROB_SLABS> filled;
+#if !defined(__EMSCRIPTEN__)
+        std::once_flag trained_loaded;
+#endif
+    };
+
+    // Not static so there is one table per program rather than one per translation unit.
+    inline ProbTable prob_table;
+}
+#endif
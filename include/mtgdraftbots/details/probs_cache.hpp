@@ -0,0 +1,178 @@
+#ifndef MTGDRAFTBOTS_DETAILS_PROBS_CACHE_HPP
+#define MTGDRAFTBOTS_DETAILS_PROBS_CACHE_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "mtgdraftbots/types.hpp"
+#include "mtgdraftbots/details/cardvalues.hpp"
+#include "mtgdraftbots/details/constants.hpp"
+#include "mtgdraftbots/details/cost_buckets.hpp"
+
+namespace mtgdraftbots::details {
+    // Everything the land combinations found by a cold generate_probs depend on: the seed, the number of seen cards,
+    // the available lands and the multiset of costs with requirements, each with how often it was picked and seen and
+    // whether it is in the pack. Which cards have those costs and the order they were listed in do not matter.
+    struct ProbsKey {
+        std::uint64_t seed;
+        std::uint64_t num_seen;
+        Lands available_lands;
+        // For each cost its CostBuckets::append_cost_key values, then whether it is in the pack, how often it was
+        // picked and how often it was seen. The costs are sorted by those values so equal multisets are equal.
+        std::vector<std::uint32_t> costs;
+
+        bool operator==(const ProbsKey&) const = default;
+    };
+
+    inline auto probs_key(const DrafterState& drafter_state, const CardValues& cards, const Lands& available_lands)
+            -> ProbsKey {
+        // Unique cost index and role (0 in pack, 1 picked, 2 seen) pairs, sorted so each cost's roles are together.
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> roles;
+        roles.reserve(drafter_state.cards_in_pack.size() + drafter_state.picked.size() + drafter_state.seen.size());
+        for (unsigned int idx : drafter_state.cards_in_pack) roles.emplace_back(cards.cost_indices[idx], 0);
+        for (unsigned int idx : drafter_state.picked) roles.emplace_back(cards.cost_indices[idx], 1);
+        for (unsigned int idx : drafter_state.seen) roles.emplace_back(cards.cost_indices[idx], 2);
+        std::sort(std::begin(roles), std::end(roles));
+        // The values of every cost are appended to one buffer and the costs are sorted as ranges of it.
+        std::vector<std::uint32_t> values;
+        std::vector<std::pair<std::size_t, std::size_t>> ranges;
+        for (std::size_t i = 0; i < roles.size();) {
+            const std::uint32_t idx = roles[i].first;
+            std::array<std::uint32_t, 3> counts{ 0 };
+            for (; i < roles.size() && roles[i].first == idx; i++) counts[roles[i].second]++;
+            const std::size_t first = values.size();
+            if (!cards.cost_buckets.append_cost_key(idx, values)) continue;
+            values.insert(std::end(values), { std::uint32_t{ counts[0] > 0 }, counts[1], counts[2] });
+            ranges.emplace_back(first, values.size());
+        }
+        const auto range = [&](const std::pair<std::size_t, std::size_t>& bounds) {
+            return std::span<const std::uint32_t>(values.data() + bounds.first, bounds.second - bounds.first);
+        };
+        std::sort(std::begin(ranges), std::end(ranges), [&](const auto& left, const auto& right) {
+            const auto left_values = range(left);
+            const auto right_values = range(right);
+            return std::lexicographical_compare(std::begin(left_values), std::end(left_values),
+                                                std::begin(right_values), std::end(right_values));
+        });
+        ProbsKey key{ drafter_state.seed, drafter_state.seen.size(), available_lands, {} };
+        key.costs.reserve(values.size());
+        for (const auto& bounds : ranges) {
+            const auto cost_values = range(bounds);
+            key.costs.insert(std::end(key.costs), std::begin(cost_values), std::end(cost_values));
+        }
+        return key;
+    }
+
+    inline auto probs_signature(const ProbsKey& key) noexcept -> std::uint64_t {
+        std::uint64_t signature = hash_combine(key.seed, key.num_seen);
+        for (std::size_t i = 0; i < key.available_lands.size(); i += 8) {
+            std::uint64_t packed = 0;
+            for (std::size_t j = 0; j < 8; j++) packed |= std::uint64_t{ key.available_lands[i + j] } << (8 * j);
+            signature = hash_combine(signature, packed);
+        }
+        for (std::uint32_t value : key.costs) signature = hash_combine(signature, value);
+        return signature;
+    }
+
+    // A bounded least recently used cache from a ProbsKey to the land combinations generate_probs found for it. It is
+    // indexed by probs_signature, and every entry keeps its key so a signature collision is a miss rather than the
+    // lands of another request. The per card probabilities are not kept since they are indexed by the card list of
+    // the request, they are rebuilt from the land combinations with one CostBuckets::evaluate each.
+    struct GenerateProbsCache {
+        static constexpr std::size_t DEFAULT_CAPACITY = 1024;
+
+        explicit GenerateProbsCache(std::size_t capacity_ = DEFAULT_CAPACITY) noexcept : max_size(capacity_) { }
+
+        auto find(const ProbsKey& key, std::array<Lands, NUM_LAND_COMBS>& lands) -> bool {
+            const std::uint64_t signature = probs_signature(key);
+            const std::lock_guard lock(mutex);
+            const auto iter = index.find(signature);
+            if (iter == std::end(index) || iter->second->key != key) {
+                num_misses++;
+                return false;
+            }
+            entries.splice(std::begin(entries), entries, iter->second);
+            lands = iter->second->lands;
+            num_hits++;
+            return true;
+        }
+
+        // On a signature collision the newer key replaces the older one.
+        void insert(ProbsKey key, const std::array<Lands, NUM_LAND_COMBS>& lands) {
+            const std::uint64_t signature = probs_signature(key);
+            const std::lock_guard lock(mutex);
+            if (max_size == 0) return;
+            if (const auto iter = index.find(signature); iter != std::end(index)) {
+                if (iter->second->key == key) return;
+                entries.erase(iter->second);
+                index.erase(iter);
+            }
+            entries.push_front({ signature, std::move(key), lands });
+            index.emplace(signature, std::begin(entries));
+            evict();
+        }
+
+        // A capacity of 0 turns the cache off.
+        void set_capacity(std::size_t capacity_) {
+            const std::lock_guard lock(mutex);
+            max_size = capacity_;
+            evict();
+        }
+
+        void clear() {
+            const std::lock_guard lock(mutex);
+            entries.clear();
+            index.clear();
+            num_hits = 0;
+            num_misses = 0;
+        }
+
+        auto capacity() const -> std::size_t {
+            const std::lock_guard lock(mutex);
+            return max_size;
+        }
+
+        auto size() const -> std::size_t {
+            const std::lock_guard lock(mutex);
+            return entries.size();
+        }
+
+        auto hits() const noexcept -> std::size_t { return num_hits; }
+
+        auto misses() const noexcept -> std::size_t { return num_misses; }
+
+    private:
+        void evict() {
+            while (entries.size() > max_size) {
+                index.erase(entries.back().signature);
+                entries.pop_back();
+            }
+        }
+
+        mutable std::mutex mutex;
+        std::size_t max_size;
+        struct Entry {
+            std::uint64_t signature;
+            ProbsKey key;
+            std::array<Lands, NUM_LAND_COMBS> lands;
+        };
+
+        // Most recently used first.
+        std::list<Entry> entries;
+        std::unordered_map<std::uint64_t, decltype(entries)::iterator> index;
+        std::atomic<std::size_t> num_hits{ 0 };
+        std::atomic<std::size_t> num_misses{ 0 };
+    };
+
+    inline static GenerateProbsCache generate_probs_cache;
+}
+#endif
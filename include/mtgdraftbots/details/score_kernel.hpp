@@ -0,0 +1,207 @@
+#ifndef MTGDRAFTBOTS_DETAILS_SCORE_KERNEL_HPP
+#define MTGDRAFTBOTS_DETAILS_SCORE_KERNEL_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "mtgdraftbots/oracles.hpp"
+#include "mtgdraftbots/types.hpp"
+#include "mtgdraftbots/details/cardvalues.hpp"
+#include "mtgdraftbots/details/simd.hpp"
+
+namespace mtgdraftbots::details {
+    // Positions in ORACLES, the fused kernel below computes the same values in the same order.
+    enum OracleIndex : std::size_t {
+        RATING_ORACLE = 0,
+        COLORS_ORACLE,
+        OPENNESS_ORACLE,
+        PICK_SYNERGY_ORACLE,
+        INTERNAL_SYNERGY_ORACLE,
+        EXTERNAL_SYNERGY_ORACLE,
+        NUM_ORACLES,
+    };
+
+    // The output of score_kernel laid out flat. The vectors only ever grow, so a ScoreBuffers that is reused across
+    // picks stops allocating once it has seen the largest pack.
+    struct ScoreBuffers {
+        std::size_t num_options{ 0 };
+        std::array<Lands, NUM_LAND_COMBS> land_combs;
+        std::array<float, NUM_ORACLES> weights{ 0.f };
+        float total_weight{ 0.f };
+        // Indexed by option * NUM_ORACLES + oracle, already divided by the largest option size like
+        // Oracle::calculate_result does.
+        std::vector<std::array<float, NUM_LAND_COMBS>> values;
+        // The oracles that score the cards of an option individually, indexed by the position of the card in the
+        // flattened options. The other oracles give every option a single entry equal to its value.
+        std::vector<std::array<float, NUM_LAND_COMBS>> rating_per_card;
+        std::vector<std::array<float, NUM_LAND_COMBS>> pick_synergy_per_card;
+        // Index of the first card of each option in the flattened options, with one extra entry at the end.
+        std::vector<std::size_t> option_offsets;
+        // The card index of each card in the flattened options.
+        std::vector<unsigned int> option_cards;
+        // The combined score over the land combinations for each option.
+        std::vector<std::array<float, NUM_LAND_COMBS>> totals;
+        // The land combination each option scores best under and that score divided by total_weight.
+        std::vector<std::size_t> best_lands;
+        std::vector<float> best_scores;
+        std::size_t chosen_option{ 0 };
+    };
+
+    namespace kernel {
+        template <typename T>
+        inline void resize_buffer(std::vector<T>& buffer, std::size_t size) {
+            if (buffer.size() < size) buffer.resize(size);
+        }
+
+        // The average synergy of cards with the pool over the land combinations. Cards without an embedding count
+        // as a neutral 0.5.
+        inline auto pool_synergy(const BotState& bot_state, const std::vector<unsigned int>& indices, bool picked) noexcept
+                -> std::array<float, NUM_LAND_COMBS> {
+            std::array<float, NUM_LAND_COMBS> scores{ 0.f };
+            if (bot_state.aggregates != nullptr) {
+                for (std::size_t i = 0; i < NUM_LAND_COMBS; i++) {
+                    const ColumnAggregates& column = bot_state.aggregates->columns[i];
+                    if (picked) scores[i] = (column.picked_directions * bot_state.pool_embeddings[i] + column.picked_probs) / 2.f;
+                    else scores[i] = (column.seen_directions * bot_state.pool_embeddings[i] + column.seen_probs) / 2.f;
+                }
+            } else {
+                for (const auto idx : indices) {
+                    const Embedding& card_embed = bot_state.cards.get().embeddings[idx];
+                    const float norm = card_embed * card_embed;
+                    if (norm <= 0.f) {
+                        scores += 0.5f * bot_state.land_combs.first[idx];
+                    } else {
+                        const std::array<float, NUM_LAND_COMBS> dots = dot_block(card_embed, bot_state.pool_transposed);
+                        for (std::size_t i = 0; i < NUM_LAND_COMBS; i++) {
+                            scores[i] += bot_state.land_combs.first[idx][i] * (dots[i] / std::sqrt(norm) + 1.f) / 2.f;
+                        }
+                    }
+                }
+            }
+            if (indices.size() > 0) scores /= static_cast<float>(indices.size());
+            return scores;
+        }
+
+        inline auto pool_ratings(const BotState& bot_state, const std::vector<unsigned int>& indices, bool picked) noexcept
+                -> std::array<float, NUM_LAND_COMBS> {
+            std::array<float, NUM_LAND_COMBS> scores{ 0.f };
+            if (bot_state.aggregates != nullptr) {
+                for (std::size_t i = 0; i < NUM_LAND_COMBS; i++) {
+                    const ColumnAggregates& column = bot_state.aggregates->columns[i];
+                    scores[i] = picked ? column.picked_ratings : column.seen_ratings;
+                }
+            } else {
+                for (const auto idx : indices) scores += bot_state.cards.get().ratings[idx] * bot_state.land_combs.first[idx];
+            }
+            if (indices.size() > 0) scores /= static_cast<float>(indices.size());
+            return scores;
+        }
+    }
+
+    // Computes everything the ORACLES compute in one pass over the options, without building an OracleMultiResult
+    // per oracle. The results match the oracles exactly, including the order the scores are summed in. Only allocates
+    // when buffers are smaller than the options need, which may throw std::bad_alloc.
+    inline void score_kernel(const BotState& bot_state, ScoreBuffers& buffers) {
+        const std::vector<Option>& options = bot_state.options;
+        const CardValues& cards = bot_state.cards.get();
+        const std::size_t num_options = options.size();
+        buffers.num_options = num_options;
+        buffers.land_combs = bot_state.land_combs.second;
+
+        buffers.total_weight = 0.f;
+        for (std::size_t j = 0; j < NUM_ORACLES; j++) {
+            buffers.weights[j] = ORACLES[j]->calculate_weight(bot_state.weighted_coords);
+            buffers.total_weight += buffers.weights[j];
+        }
+
+        kernel::resize_buffer(buffers.option_offsets, num_options + 1);
+        std::size_t num_cards = 0;
+        std::size_t max_count = 1;
+        for (std::size_t i = 0; i < num_options; i++) {
+            buffers.option_offsets[i] = num_cards;
+            num_cards += options[i].size();
+            max_count = std::max(max_count, options[i].size());
+        }
+        buffers.option_offsets[num_options] = num_cards;
+        kernel::resize_buffer(buffers.option_cards, num_cards);
+        kernel::resize_buffer(buffers.values, num_options * NUM_ORACLES);
+        kernel::resize_buffer(buffers.rating_per_card, num_cards);
+        kernel::resize_buffer(buffers.pick_synergy_per_card, num_cards);
+        kernel::resize_buffer(buffers.totals, num_options);
+        kernel::resize_buffer(buffers.best_lands, num_options);
+        kernel::resize_buffer(buffers.best_scores, num_options);
+
+        // The pool oracles do not depend on the option.
+        const std::array<float, NUM_LAND_COMBS> colors = kernel::pool_ratings(bot_state, bot_state.picked, true);
+        const std::array<float, NUM_LAND_COMBS> openness = kernel::pool_ratings(bot_state, bot_state.seen, false);
+        const std::array<float, NUM_LAND_COMBS> internal = kernel::pool_synergy(bot_state, bot_state.picked, true);
+        const std::array<float, NUM_LAND_COMBS> external = kernel::pool_synergy(bot_state, bot_state.seen, false);
+
+        // The dot products of every card in the options with the pool embeddings as one block, kept in
+        // pick_synergy_per_card until they are turned into the scores below.
+        for (std::size_t option = 0; option < num_options; option++) {
+            for (std::size_t k = 0; k < options[option].size(); k++) {
+                buffers.option_cards[buffers.option_offsets[option] + k] = bot_state.cards_in_pack[options[option][k]];
+            }
+        }
+        dot_block(cards.embeddings, std::span(buffers.option_cards.data(), num_cards), bot_state.pool_transposed,
+                  std::span(buffers.pick_synergy_per_card.data(), num_cards));
+
+        for (std::size_t option = 0; option < num_options; option++) {
+            std::array<float, NUM_LAND_COMBS> rating{ 0.f };
+            std::array<float, NUM_LAND_COMBS> pick_synergy{ 0.f };
+            for (std::size_t k = 0; k < options[option].size(); k++) {
+                const std::size_t idx = buffers.option_cards[buffers.option_offsets[option] + k];
+                const std::array<float, NUM_LAND_COMBS>& probs = bot_state.land_combs.first[idx];
+                std::array<float, NUM_LAND_COMBS>& card_rating = buffers.rating_per_card[buffers.option_offsets[option] + k];
+                std::array<float, NUM_LAND_COMBS>& card_synergy = buffers.pick_synergy_per_card[buffers.option_offsets[option] + k];
+                for (std::size_t i = 0; i < NUM_LAND_COMBS; i++) card_rating[i] = cards.ratings[idx] * probs[i];
+                const Embedding& card_embed = cards.embeddings[idx];
+                const float norm = card_embed * card_embed;
+                if (norm <= 0.f) {
+                    card_synergy = { 0.f };
+                } else {
+                    for (std::size_t i = 0; i < NUM_LAND_COMBS; i++) {
+                        card_synergy[i] = probs[i] * (card_synergy[i] / std::sqrt(norm) + 1.f) / 2.f;
+                    }
+                }
+                rating += card_rating;
+                pick_synergy += card_synergy;
+            }
+            rating /= static_cast<float>(max_count);
+            pick_synergy /= static_cast<float>(max_count);
+
+            std::array<float, NUM_LAND_COMBS>* values = &buffers.values[option * NUM_ORACLES];
+            values[RATING_ORACLE] = rating;
+            values[COLORS_ORACLE] = colors;
+            values[OPENNESS_ORACLE] = openness;
+            values[PICK_SYNERGY_ORACLE] = pick_synergy;
+            values[INTERNAL_SYNERGY_ORACLE] = internal;
+            values[EXTERNAL_SYNERGY_ORACLE] = external;
+
+            std::array<float, NUM_LAND_COMBS>& total = buffers.totals[option];
+            total = { 0.f };
+            for (std::size_t j = 0; j < NUM_ORACLES; j++) total += buffers.weights[j] * values[j];
+            std::size_t best_index = 0;
+            for (std::size_t i = 1; i < NUM_LAND_COMBS; i++) {
+                if (total[i] > total[best_index]) best_index = i;
+            }
+            buffers.best_lands[option] = best_index;
+            buffers.best_scores[option] = total[best_index] / buffers.total_weight;
+        }
+
+        buffers.chosen_option = 0;
+        float best_result = -1;
+        for (std::size_t option = 0; option < num_options; option++) {
+            if (buffers.best_scores[option] > best_result) {
+                buffers.chosen_option = option;
+                best_result = buffers.best_scores[option];
+            }
+        }
+    }
+}
+#endif
@@ -5,11 +5,19 @@
 #include <bit>
 #include <cmath>
 #include <concepts>
+#include <cstdint>
+#include <span>
 
 #ifdef USE_VECTORCLASS
 #include <vectorclass.h>
 #endif
 
+#include "mtgdraftbots/details/dispatch.hpp"
+
+#ifdef MTGDRAFTBOTS_WASM_SIMD
+#include <wasm_simd128.h>
+#endif
+
 namespace mtgdraftbots {
     using Lands = std::array<unsigned char, 32>;
 
@@ -73,6 +81,115 @@ namespace mtgdraftbots {
             (~maskVec).store(result.data());
             return result;
         }
+
+        // Embeddings are processed as EMBEDDING_SIZE / 8 Vec8f.
+        inline auto vcl_dot(const Embedding& emb1, const Embedding& emb2) -> float {
+            vcl::Vec8f result(0.f);
+            for (std::size_t i = 0; i < EMBEDDING_SIZE; i += 8) {
+                vcl::Vec8f emb1Vec;
+                emb1Vec.load(emb1.data() + i);
+                vcl::Vec8f emb2Vec;
+                emb2Vec.load(emb2.data() + i);
+                result += emb1Vec * emb2Vec;
+            }
+            return vcl::horizontal_add(result);
+        }
+
+        inline void vcl_add_weighted(Embedding& emb, float weight, const Embedding& value) {
+            const vcl::Vec8f weightVec(weight);
+            for (std::size_t i = 0; i < EMBEDDING_SIZE; i += 8) {
+                vcl::Vec8f embVec;
+                embVec.load(emb.data() + i);
+                vcl::Vec8f valueVec;
+                valueVec.load(value.data() + i);
+                (embVec + weightVec * valueVec).store(emb.data() + i);
+            }
+        }
+
+        inline void vcl_add(Embedding& emb1, const Embedding& emb2) {
+            for (std::size_t i = 0; i < EMBEDDING_SIZE; i += 8) {
+                vcl::Vec8f emb1Vec;
+                emb1Vec.load(emb1.data() + i);
+                vcl::Vec8f emb2Vec;
+                emb2Vec.load(emb2.data() + i);
+                (emb1Vec + emb2Vec).store(emb1.data() + i);
+            }
+        }
+
+        inline void vcl_divide(Embedding& emb, float value) {
+            const vcl::Vec8f valueVec(value);
+            for (std::size_t i = 0; i < EMBEDDING_SIZE; i += 8) {
+                vcl::Vec8f embVec;
+                embVec.load(emb.data() + i);
+                (embVec / valueVec).store(emb.data() + i);
+            }
+        }
+#endif
+
+#ifdef MTGDRAFTBOTS_WASM_SIMD
+        // The same primitives as the vectorclass ones above on 128 bit WebAssembly SIMD vectors.
+        inline auto simd128_sum_masked(const LandsMask& mask, const Lands& lands) -> std::uint32_t {
+            const v128_t masked_low = wasm_v128_and(wasm_v128_load(mask.data()), wasm_v128_load(lands.data()));
+            const v128_t masked_high = wasm_v128_and(wasm_v128_load(mask.data() + 16), wasm_v128_load(lands.data() + 16));
+            const v128_t sums = wasm_u32x4_extadd_pairwise_u16x8(wasm_i16x8_add(wasm_u16x8_extadd_pairwise_u8x16(masked_low),
+                                                                                wasm_u16x8_extadd_pairwise_u8x16(masked_high)));
+            return static_cast<std::uint32_t>(wasm_i32x4_extract_lane(sums, 0) + wasm_i32x4_extract_lane(sums, 1)
+                                              + wasm_i32x4_extract_lane(sums, 2) + wasm_i32x4_extract_lane(sums, 3));
+        }
+
+        inline auto simd128_operator_or(const LandsMask& mask1, const LandsMask& mask2) -> LandsMask {
+            LandsMask result;
+            for (std::size_t i = 0; i < result.size(); i += 16) {
+                wasm_v128_store(result.data() + i, wasm_v128_or(wasm_v128_load(mask1.data() + i), wasm_v128_load(mask2.data() + i)));
+            }
+            return result;
+        }
+
+        inline auto simd128_operator_and(const LandsMask& mask1, const LandsMask& mask2) -> LandsMask {
+            LandsMask result;
+            for (std::size_t i = 0; i < result.size(); i += 16) {
+                wasm_v128_store(result.data() + i, wasm_v128_and(wasm_v128_load(mask1.data() + i), wasm_v128_load(mask2.data() + i)));
+            }
+            return result;
+        }
+
+        inline auto simd128_operator_not(const LandsMask& mask) -> LandsMask {
+            LandsMask result;
+            for (std::size_t i = 0; i < result.size(); i += 16) {
+                wasm_v128_store(result.data() + i, wasm_v128_not(wasm_v128_load(mask.data() + i)));
+            }
+            return result;
+        }
+
+        inline auto simd128_dot(const Embedding& emb1, const Embedding& emb2) -> float {
+            v128_t result = wasm_f32x4_splat(0.f);
+            for (std::size_t i = 0; i < EMBEDDING_SIZE; i += 4) {
+                result = wasm_f32x4_add(result, wasm_f32x4_mul(wasm_v128_load(emb1.data() + i), wasm_v128_load(emb2.data() + i)));
+            }
+            return wasm_f32x4_extract_lane(result, 0) + wasm_f32x4_extract_lane(result, 1)
+                 + wasm_f32x4_extract_lane(result, 2) + wasm_f32x4_extract_lane(result, 3);
+        }
+
+        inline void simd128_add_weighted(Embedding& emb, float weight, const Embedding& value) {
+            const v128_t weight_vec = wasm_f32x4_splat(weight);
+            for (std::size_t i = 0; i < EMBEDDING_SIZE; i += 4) {
+                wasm_v128_store(emb.data() + i, wasm_f32x4_add(wasm_v128_load(emb.data() + i),
+                                                               wasm_f32x4_mul(weight_vec, wasm_v128_load(value.data() + i))));
+            }
+        }
+
+        inline void simd128_add(Embedding& emb1, const Embedding& emb2) {
+            for (std::size_t i = 0; i < EMBEDDING_SIZE; i += 4) {
+                wasm_v128_store(emb1.data() + i, wasm_f32x4_add(wasm_v128_load(emb1.data() + i), wasm_v128_load(emb2.data() + i)));
+            }
+        }
+
+        inline void simd128_divide(Embedding& emb, float value) {
+            const v128_t value_vec = wasm_f32x4_splat(value);
+            for (std::size_t i = 0; i < EMBEDDING_SIZE; i += 4) {
+                wasm_v128_store(emb.data() + i, wasm_f32x4_div(wasm_v128_load(emb.data() + i), value_vec));
+            }
+        }
 #endif
 
         constexpr auto sum_masked(const LandsMask& mask, const Lands& lands) -> unsigned char {
@@ -80,6 +197,10 @@ namespace mtgdraftbots {
             if (!std::is_constant_evaluated()) {
                 return static_cast<unsigned char>(vcl_sum_masked(mask, lands));
             }
+#elif defined(MTGDRAFTBOTS_WASM_SIMD)
+            if (!std::is_constant_evaluated()) {
+                return static_cast<unsigned char>(simd128_sum_masked(mask, lands));
+            }
 #endif
             std::uint64_t result_64 = 0;
             for (unsigned char i = 0; i < 4; i++) {
@@ -93,11 +214,30 @@ namespace mtgdraftbots {
             return static_cast<unsigned char>(result_16[0] + result_16[1]);
         }
 
+        // sum_masked for several masks at once. Without an explicit SIMD backend it is written as plain byte loops so
+        // each cloned variant vectorizes them for its instruction set.
+        MTGDRAFTBOTS_TARGET_CLONES
+        inline void sum_masked(std::span<const LandsMask> masks, const Lands& lands, std::span<std::uint8_t> out) noexcept {
+            for (std::size_t i = 0; i < masks.size(); i++) {
+#if defined(USE_VECTORCLASS) || defined(MTGDRAFTBOTS_WASM_SIMD)
+                out[i] = sum_masked(masks[i], lands);
+#else
+                std::uint8_t result = 0;
+                for (std::size_t j = 0; j < lands.size(); j++) result += static_cast<std::uint8_t>(static_cast<unsigned char>(masks[i][j]) & lands[j]);
+                out[i] = result;
+#endif
+            }
+        }
+
         constexpr auto operator|(const LandsMask& mask1, const LandsMask& mask2) -> LandsMask {
 #ifdef USE_VECTORCLASS
             if (!std::is_constant_evaluated()) {
                 return vcl_operator_or(mask1, mask2);
             }
+#elif defined(MTGDRAFTBOTS_WASM_SIMD)
+            if (!std::is_constant_evaluated()) {
+                return simd128_operator_or(mask1, mask2);
+            }
 #endif
             std::array<std::uint64_t, 4> result;
             for (unsigned char i = 0; i < 4; i++) {
@@ -112,6 +252,10 @@ namespace mtgdraftbots {
             if (!std::is_constant_evaluated()) {
                 return vcl_operator_and(mask1, mask2);
             }
+#elif defined(MTGDRAFTBOTS_WASM_SIMD)
+            if (!std::is_constant_evaluated()) {
+                return simd128_operator_and(mask1, mask2);
+            }
 #endif
             std::array<std::uint64_t, 4> result;
             for (unsigned char i = 0; i < 4; i++) {
@@ -126,6 +270,10 @@ namespace mtgdraftbots {
             if (!std::is_constant_evaluated()) {
                 return vcl_operator_not(mask);
             }
+#elif defined(MTGDRAFTBOTS_WASM_SIMD)
+            if (!std::is_constant_evaluated()) {
+                return simd128_operator_not(mask);
+            }
 #endif
             std::array<std::uint64_t, 4> result;
             for (unsigned char i = 0; i < 4; i++) {
@@ -136,6 +284,21 @@ namespace mtgdraftbots {
 
         template<typename Container>
         constexpr auto operator+=(Container& emb1, const Container& emb2) noexcept -> Container& {
+#ifdef USE_VECTORCLASS
+            if constexpr (std::same_as<Container, Embedding>) {
+                if (!std::is_constant_evaluated()) {
+                    vcl_add(emb1, emb2);
+                    return emb1;
+                }
+            }
+#elif defined(MTGDRAFTBOTS_WASM_SIMD)
+            if constexpr (std::same_as<Container, Embedding>) {
+                if (!std::is_constant_evaluated()) {
+                    simd128_add(emb1, emb2);
+                    return emb1;
+                }
+            }
+#endif
             for (std::size_t i = 0; i < emb1.size(); i++) emb1[i] += emb2[i];
             return emb1;
         }
@@ -149,6 +312,21 @@ namespace mtgdraftbots {
         template<typename Container>
         constexpr auto operator+=(Container& emb,
                                   Weighted<Container> weighted_emb) noexcept -> Container& {
+#ifdef USE_VECTORCLASS
+            if constexpr (std::same_as<Container, Embedding>) {
+                if (!std::is_constant_evaluated()) {
+                    vcl_add_weighted(emb, weighted_emb.weight, weighted_emb.value);
+                    return emb;
+                }
+            }
+#elif defined(MTGDRAFTBOTS_WASM_SIMD)
+            if constexpr (std::same_as<Container, Embedding>) {
+                if (!std::is_constant_evaluated()) {
+                    simd128_add_weighted(emb, weighted_emb.weight, weighted_emb.value);
+                    return emb;
+                }
+            }
+#endif
             for (std::size_t i = 0; i < emb.size(); i++) emb[i] += weighted_emb.weight * weighted_emb.value[i];
             return emb;
         }
@@ -160,6 +338,15 @@ namespace mtgdraftbots {
 
         template <typename Container>
         constexpr auto operator*(const Container& emb1, const Container& emb2) noexcept -> typename Container::value_type {
+#ifdef USE_VECTORCLASS
+            if constexpr (std::same_as<Container, Embedding>) {
+                if (!std::is_constant_evaluated()) return vcl_dot(emb1, emb2);
+            }
+#elif defined(MTGDRAFTBOTS_WASM_SIMD)
+            if constexpr (std::same_as<Container, Embedding>) {
+                if (!std::is_constant_evaluated()) return simd128_dot(emb1, emb2);
+            }
+#endif
             typename Container::value_type result = 0.f;
             for (std::size_t i = 0; i < emb1.size(); i++) result += emb1[i] * emb2[i];
             return result;
@@ -167,6 +354,21 @@ namespace mtgdraftbots {
 
         template <typename Container>
         constexpr auto operator/=(Container& emb, typename Container::value_type value) noexcept -> Container& {
+#ifdef USE_VECTORCLASS
+            if constexpr (std::same_as<Container, Embedding>) {
+                if (!std::is_constant_evaluated()) {
+                    vcl_divide(emb, value);
+                    return emb;
+                }
+            }
+#elif defined(MTGDRAFTBOTS_WASM_SIMD)
+            if constexpr (std::same_as<Container, Embedding>) {
+                if (!std::is_constant_evaluated()) {
+                    simd128_divide(emb, value);
+                    return emb;
+                }
+            }
+#endif
             for (std::size_t i = 0; i < emb.size(); i++) emb[i] /= value;
             return emb;
         }
@@ -178,6 +380,77 @@ namespace mtgdraftbots {
             else emb /= std::sqrt(norm);
             return emb;
         }
+
+        // N embeddings stored dimension major, so the dot products of one embedding with all N of them are a single
+        // pass over the dimensions.
+        template <std::size_t N>
+        using TransposedEmbeddings = std::array<std::array<float, N>, EMBEDDING_SIZE>;
+
+        template <std::size_t N>
+        constexpr auto transpose_embeddings(const std::array<Embedding, N>& embeddings) noexcept -> TransposedEmbeddings<N> {
+            TransposedEmbeddings<N> result;
+            for (std::size_t i = 0; i < EMBEDDING_SIZE; i++) {
+                for (std::size_t j = 0; j < N; j++) result[i][j] = embeddings[j][i];
+            }
+            return result;
+        }
+
+#ifdef USE_VECTORCLASS
+        inline auto vcl_dot_block(const Embedding& embedding, const TransposedEmbeddings<8>& transposed) -> std::array<float, 8> {
+            vcl::Vec8f result(0.f);
+            for (std::size_t i = 0; i < EMBEDDING_SIZE; i++) {
+                vcl::Vec8f row;
+                row.load(transposed[i].data());
+                result += vcl::Vec8f(embedding[i]) * row;
+            }
+            std::array<float, 8> dots;
+            result.store(dots.data());
+            return dots;
+        }
+#endif
+#ifdef MTGDRAFTBOTS_WASM_SIMD
+        inline auto simd128_dot_block(const Embedding& embedding, const TransposedEmbeddings<8>& transposed) -> std::array<float, 8> {
+            v128_t low = wasm_f32x4_splat(0.f);
+            v128_t high = wasm_f32x4_splat(0.f);
+            for (std::size_t i = 0; i < EMBEDDING_SIZE; i++) {
+                const v128_t value = wasm_f32x4_splat(embedding[i]);
+                low = wasm_f32x4_add(low, wasm_f32x4_mul(value, wasm_v128_load(transposed[i].data())));
+                high = wasm_f32x4_add(high, wasm_f32x4_mul(value, wasm_v128_load(transposed[i].data() + 4)));
+            }
+            std::array<float, 8> dots;
+            wasm_v128_store(dots.data(), low);
+            wasm_v128_store(dots.data() + 4, high);
+            return dots;
+        }
+#endif
+
+        // The dot products of embedding with each of the transposed embeddings. Every lane sums over the dimensions
+        // in order, so on the scalar path these match operator* exactly.
+        template <std::size_t N>
+        constexpr auto dot_block(const Embedding& embedding, const TransposedEmbeddings<N>& transposed) noexcept -> std::array<float, N> {
+#ifdef USE_VECTORCLASS
+            if constexpr (N == 8) {
+                if (!std::is_constant_evaluated()) return vcl_dot_block(embedding, transposed);
+            }
+#elif defined(MTGDRAFTBOTS_WASM_SIMD)
+            if constexpr (N == 8) {
+                if (!std::is_constant_evaluated()) return simd128_dot_block(embedding, transposed);
+            }
+#endif
+            std::array<float, N> result{ 0.f };
+            for (std::size_t i = 0; i < EMBEDDING_SIZE; i++) {
+                for (std::size_t j = 0; j < N; j++) result[j] += embedding[i] * transposed[i][j];
+            }
+            return result;
+        }
+
+        // The N x EMBEDDING_SIZE by EMBEDDING_SIZE x 8 block of dot products between the embeddings at indices and
+        // the transposed ones, written to out row by row.
+        MTGDRAFTBOTS_TARGET_CLONES
+        inline void dot_block(std::span<const Embedding> embeddings, std::span<const unsigned int> indices,
+                              const TransposedEmbeddings<8>& transposed, std::span<std::array<float, 8>> out) noexcept {
+            for (std::size_t i = 0; i < indices.size(); i++) out[i] = dot_block(embeddings[indices[i]], transposed);
+        }
     }
 }
 #endif
\ No newline at end of file
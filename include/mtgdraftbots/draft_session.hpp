@@ -0,0 +1,144 @@
+#ifndef MTGDRAFTBOTS_DRAFT_SESSION_HPP
+#define MTGDRAFTBOTS_DRAFT_SESSION_HPP
+
+#include <algorithm>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "mtgdraftbots/mtgdraftbots.hpp"
+
+namespace mtgdraftbots {
+    // Carries a single drafter through a draft. The card list is resolved once, and picked and seen only ever grow,
+    // so the available lands and the sums the pool based oracles need are extended with the new cards each pick
+    // instead of being rebuilt from the whole history. The land search of each pick is warm started from the land
+    // combinations found for the previous one. Card indices out of range of card_oracle_ids, and picks
+    // invalid_pick_reason rejects, throw std::invalid_argument and leave picked and seen as they were.
+    struct DraftSession {
+        // picked, seen, basics, card_oracle_ids and the pick counts are taken from initial_state, cards_in_pack,
+        // pack_num and pick_num are supplied per pick.
+        explicit DraftSession(const DrafterState& initial_state)
+            : DraftSession(initial_state, std::make_shared<const details::CardValues>(initial_state.card_oracle_ids),
+                           test_recognized(initial_state.card_oracle_ids)) { }
+
+        // Lets many sessions, e.g. every seat of a pod, share one resolved card list.
+        DraftSession(const DrafterState& initial_state, std::shared_ptr<const details::CardValues> cards_,
+                     std::vector<int> recognized_)
+            : cards(std::move(cards_)), recognized(std::move(recognized_)),
+              bot_state{ checked(initial_state), {}, {}, {}, std::cref(*cards) },
+              available_lands(details::get_available_lands(initial_state, *cards)) { }
+
+        void add_picked(unsigned int card_index) {
+            check_indices(std::span<const unsigned int>(&card_index, 1));
+            bot_state.picked.push_back(card_index);
+            if (cards->produces[card_index] < 32) available_lands[cards->produces[card_index]]++;
+        }
+
+        void add_seen(std::span<const unsigned int> card_indices) {
+            check_indices(card_indices);
+            bot_state.seen.insert(std::end(bot_state.seen), std::begin(card_indices), std::end(card_indices));
+        }
+
+        auto calculate_pick(const std::vector<unsigned int>& cards_in_pack, const std::vector<Option>& options,
+                            unsigned int pack_num, unsigned int pick_num) -> BotResult {
+            prepare_pick(cards_in_pack, options, pack_num, pick_num);
+            BotResult result{ drafter_state(), options, recognized, {}, 0 };
+            details::score_options(bot_state, result, score_buffers);
+            return result;
+        }
+
+        // Returns only the choice, scores and lands, the oracle breakdown stays available through the explanation.
+        auto calculate_lean_pick(const std::vector<unsigned int>& cards_in_pack, const std::vector<Option>& options,
+                                 unsigned int pack_num, unsigned int pick_num) -> LeanBotResult {
+            prepare_pick(cards_in_pack, options, pack_num, pick_num);
+            return details::score_options_lean(bot_state, lean_score_buffers);
+        }
+
+        auto drafter_state() const noexcept -> const DrafterState& { return bot_state; }
+
+        // How the land search went for the last call to calculate_pick.
+        auto last_generate_probs_stats() const noexcept -> const details::GenerateProbsStats& { return generate_probs_stats; }
+
+    private:
+        static auto checked(const DrafterState& initial_state) -> const DrafterState& {
+            for (const std::vector<unsigned int>* indices : { &initial_state.picked, &initial_state.seen, &initial_state.basics }) {
+                check_indices(*indices, initial_state.card_oracle_ids.size());
+            }
+            return initial_state;
+        }
+
+        static void check_indices(std::span<const unsigned int> indices, std::size_t num_cards) {
+            if (!std::ranges::all_of(indices, [num_cards](unsigned int idx) { return idx < num_cards; })) {
+                throw std::invalid_argument("A card index is out of range of cardOracleIds.");
+            }
+        }
+
+        void check_indices(std::span<const unsigned int> indices) const {
+            check_indices(indices, bot_state.card_oracle_ids.size());
+        }
+
+        void prepare_pick(const std::vector<unsigned int>& cards_in_pack, const std::vector<Option>& options,
+                          unsigned int pack_num, unsigned int pick_num) {
+            bot_state.cards_in_pack = cards_in_pack;
+            bot_state.options = options;
+            bot_state.pack_num = pack_num;
+            bot_state.pick_num = pick_num;
+            if (const char* reason = details::invalid_pick_reason(bot_state, options); reason != nullptr) {
+                throw std::invalid_argument(reason);
+            }
+            const std::array<Lands, details::NUM_LAND_COMBS> previous_lands = bot_state.land_combs.second;
+            bot_state.land_combs = details::generate_probs(bot_state, *cards, available_lands,
+                                                           has_aggregates ? &previous_lands : nullptr, &generate_probs_stats);
+            bot_state.weighted_coords = details::get_weighted_coords(bot_state);
+            update_aggregates();
+            bot_state.aggregates = &aggregates;
+            bot_state.calculate_embeddings();
+        }
+
+        // A column can keep its sums when the new land combination matches one from the last pick, since every
+        // card already counted has the same probability under it. Otherwise the column is rebuilt.
+        void update_aggregates() {
+            details::PoolAggregates updated;
+            for (std::size_t i = 0; i < details::NUM_LAND_COMBS; i++) {
+                const Lands& lands = bot_state.land_combs.second[i];
+                details::ColumnAggregates& column = updated.columns[i];
+                std::size_t picked_start = 0;
+                std::size_t seen_start = 0;
+                const auto previous = std::find_if(std::begin(aggregates.columns), std::end(aggregates.columns),
+                                                   [&](const details::ColumnAggregates& other) { return other.lands == lands; });
+                if (has_aggregates && previous != std::end(aggregates.columns)) {
+                    column = *previous;
+                    picked_start = aggregates.num_picked;
+                    seen_start = aggregates.num_seen;
+                } else {
+                    column.lands = lands;
+                }
+                for (std::size_t j = picked_start; j < bot_state.picked.size(); j++) {
+                    const std::size_t idx = bot_state.picked[j];
+                    details::add_to_column(column, *cards, idx, bot_state.land_combs.first[idx][i], true);
+                }
+                for (std::size_t j = seen_start; j < bot_state.seen.size(); j++) {
+                    const std::size_t idx = bot_state.seen[j];
+                    details::add_to_column(column, *cards, idx, bot_state.land_combs.first[idx][i], false);
+                }
+            }
+            updated.num_picked = bot_state.picked.size();
+            updated.num_seen = bot_state.seen.size();
+            aggregates = updated;
+            has_aggregates = true;
+        }
+
+        std::shared_ptr<const details::CardValues> cards;
+        std::vector<int> recognized;
+        details::BotState bot_state;
+        Lands available_lands;
+        details::PoolAggregates aggregates;
+        bool has_aggregates{ false };
+        details::GenerateProbsStats generate_probs_stats;
+        details::ScoreBuffers score_buffers;
+        std::shared_ptr<details::ScoreBuffers> lean_score_buffers;
+    };
+}
+#endif
@@ -0,0 +1,142 @@
+#ifndef MTGDRAFTBOTS_DRAFT_SIMULATOR_HPP
+#define MTGDRAFTBOTS_DRAFT_SIMULATOR_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "mtgdraftbots/draft_session.hpp"
+#include "mtgdraftbots/mtgdraftbots.hpp"
+
+namespace mtgdraftbots {
+    struct PodConfig {
+        unsigned int num_seats{ 8 };
+        unsigned int num_packs{ 3 };
+        unsigned int pack_size{ 15 };
+    };
+
+    // Card indices are into card_oracle_ids of the simulator, the cube followed by the basics.
+    struct DraftLog {
+        std::uint64_t seed;
+        // packs[pack_num][seat] is the pack that seat opened.
+        std::vector<std::vector<std::vector<unsigned int>>> packs;
+        // picks[seat][pick] across all packs, in the order they were made.
+        std::vector<std::vector<unsigned int>> picks;
+    };
+
+    // Runs whole pods of bots. Packs are dealt from a shuffle of the cube and passed left, then right, alternating by
+    // pack. Everything random in a draft comes from its seed, so a draft can be replayed from its log.
+    struct DraftSimulator {
+        DraftSimulator(std::vector<std::string> cube, const std::vector<std::string>& basics, PodConfig config_)
+            : cube_size(static_cast<unsigned int>(cube.size())), config(config_) {
+            card_oracle_ids = std::move(cube);
+            card_oracle_ids.insert(std::end(card_oracle_ids), std::begin(basics), std::end(basics));
+            for (unsigned int i = cube_size; i < card_oracle_ids.size(); i++) basic_indices.push_back(i);
+            cards = std::make_shared<const details::CardValues>(card_oracle_ids);
+            recognized = test_recognized(card_oracle_ids);
+        }
+
+        // The cube has to hold a pack for every seat for every pack of the draft.
+        auto valid() const noexcept -> bool {
+            return config.num_seats > 0 && config.num_packs > 0 && config.pack_size > 0
+                && std::size_t{ config.num_seats } * config.num_packs * config.pack_size <= cube_size;
+        }
+
+        auto pod_config() const noexcept -> const PodConfig& { return config; }
+
+        auto picks_per_draft() const noexcept -> std::size_t {
+            return std::size_t{ config.num_seats } * config.num_packs * config.pack_size;
+        }
+
+        auto simulate(std::uint64_t seed) const -> DraftLog {
+            std::mt19937_64 rng(seed);
+            DraftLog log{ seed, deal_packs(rng), std::vector<std::vector<unsigned int>>(config.num_seats) };
+            DrafterState initial_state{};
+            initial_state.basics = basic_indices;
+            initial_state.card_oracle_ids = card_oracle_ids;
+            initial_state.num_packs = config.num_packs;
+            initial_state.num_picks = config.pack_size;
+            std::vector<DraftSession> sessions;
+            sessions.reserve(config.num_seats);
+            for (unsigned int seat = 0; seat < config.num_seats; seat++) {
+                initial_state.seed = static_cast<unsigned int>(rng());
+                sessions.emplace_back(initial_state, cards, recognized);
+                log.picks[seat].reserve(std::size_t{ config.num_packs } * config.pack_size);
+            }
+            std::vector<Option> options;
+            for (unsigned int pack_num = 0; pack_num < config.num_packs; pack_num++) {
+                std::vector<std::vector<unsigned int>> in_hand = log.packs[pack_num];
+                for (unsigned int pick_num = 0; pick_num < config.pack_size; pick_num++) {
+                    for (unsigned int seat = 0; seat < config.num_seats; seat++) {
+                        std::vector<unsigned int>& pack = in_hand[seat];
+                        options.resize(pack.size());
+                        for (unsigned int i = 0; i < pack.size(); i++) options[i] = { i };
+                        DraftSession& session = sessions[seat];
+                        session.add_seen(pack);
+                        const unsigned int chosen = session.calculate_lean_pick(pack, options, pack_num, pick_num).chosen_option;
+                        session.add_picked(pack[chosen]);
+                        log.picks[seat].push_back(pack[chosen]);
+                        pack.erase(std::begin(pack) + chosen);
+                    }
+                    if (pack_num % 2 == 0) {
+                        std::rotate(std::rbegin(in_hand), std::rbegin(in_hand) + 1, std::rend(in_hand));
+                    } else {
+                        std::rotate(std::begin(in_hand), std::begin(in_hand) + 1, std::end(in_hand));
+                    }
+                }
+            }
+            return log;
+        }
+
+        // Simulates the drafts with seeds first_seed to first_seed + num_drafts - 1 and calls on_draft(log) for each
+        // as it finishes. With num_threads > 1 the drafts run concurrently and on_draft has to be thread safe.
+        template <typename OnDraft>
+        void simulate_many(std::uint64_t first_seed, std::size_t num_drafts, std::size_t num_threads, OnDraft&& on_draft) const {
+            if (num_drafts == 0) return;
+            num_threads = std::clamp<std::size_t>(num_threads, 1, num_drafts);
+            std::atomic<std::size_t> next_draft{ 0 };
+            const auto worker = [&]() {
+                for (std::size_t draft = next_draft++; draft < num_drafts; draft = next_draft++) {
+                    on_draft(simulate(first_seed + draft));
+                }
+            };
+            std::vector<std::jthread> workers;
+            workers.reserve(num_threads - 1);
+            for (std::size_t i = 1; i < num_threads; i++) workers.emplace_back(worker);
+            worker();
+        }
+
+    private:
+        auto deal_packs(std::mt19937_64& rng) const -> std::vector<std::vector<std::vector<unsigned int>>> {
+            std::vector<unsigned int> shuffled(cube_size);
+            std::iota(std::begin(shuffled), std::end(shuffled), 0u);
+            std::shuffle(std::begin(shuffled), std::end(shuffled), rng);
+            std::vector<std::vector<std::vector<unsigned int>>> packs(config.num_packs,
+                                                                      std::vector<std::vector<unsigned int>>(config.num_seats));
+            auto next_card = std::begin(shuffled);
+            for (auto& round : packs) {
+                for (auto& pack : round) {
+                    pack.assign(next_card, next_card + config.pack_size);
+                    next_card += config.pack_size;
+                }
+            }
+            return packs;
+        }
+
+        std::vector<std::string> card_oracle_ids;
+        std::vector<unsigned int> basic_indices;
+        unsigned int cube_size;
+        PodConfig config;
+        std::shared_ptr<const details::CardValues> cards;
+        std::vector<int> recognized;
+    };
+}
+#endif
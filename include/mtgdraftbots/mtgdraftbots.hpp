@@ -3,16 +3,23 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <bit>
 #include <cstring>
 #include <cstdint>
+#include <exception>
 #include <functional>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <random>
+#include <stdexcept>
+#include <span>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <type_traits>
 #include <variant>
 #include <vector>
@@ -24,7 +31,10 @@
 #include "mtgdraftbots/details/cardcost.hpp"
 #include "mtgdraftbots/details/cardvalues.hpp"
 #include "mtgdraftbots/details/constants.hpp"
+#include "mtgdraftbots/details/cost_buckets.hpp"
 #include "mtgdraftbots/details/generate_probs.hpp"
+#include "mtgdraftbots/details/params.hpp"
+#include "mtgdraftbots/details/score_kernel.hpp"
 
 namespace mtgdraftbots {
     struct BotScore {
@@ -40,154 +50,423 @@ namespace mtgdraftbots {
         unsigned int chosen_option;
     };
 
+    // A handle to the scores behind a LeanBotResult. The oracle breakdown is only built if explain is called, and
+    // the handle can be kept for as long as it is needed after the pick.
+    struct PickExplanation {
+        PickExplanation() = default;
+        explicit PickExplanation(std::shared_ptr<const details::ScoreBuffers> buffers_) noexcept : buffers(std::move(buffers_)) { }
+
+        explicit operator bool() const noexcept { return buffers != nullptr; }
+
+        // The same scores a BotResult for the pick would hold, empty for a default constructed handle.
+        auto explain() const -> std::vector<BotScore>;
+
+    private:
+        std::shared_ptr<const details::ScoreBuffers> buffers;
+    };
+
+    // The result of a pick without the echoed DrafterState and oracle breakdown, for callers that only act on the
+    // choice. scores and lands are indexed by option like BotResult::scores.
+    struct LeanBotResult {
+        unsigned int chosen_option;
+        std::vector<float> scores;
+        std::vector<Lands> lands;
+        PickExplanation explanation;
+    };
+
     namespace details {
         constexpr void BotState::calculate_embeddings() & noexcept {
-            for (std::size_t i = 0; i < NUM_LAND_COMBS; i++) {
-                for (std::size_t idx : picked) {
-                    pool_embeddings[i] += land_combs.first[idx][i] * cards.get().embeddings[idx];
+            if (aggregates != nullptr) {
+                pool_embeddings = { embedding_bias };
+                for (std::size_t i = 0; i < NUM_LAND_COMBS; i++) {
+                    pool_embeddings[i] += aggregates->columns[i].pool_embedding;
+                    l2_normalize(pool_embeddings[i]);
+                }
+            } else {
+                for (std::size_t i = 0; i < NUM_LAND_COMBS; i++) {
+                    for (std::size_t idx : picked) {
+                        pool_embeddings[i] += land_combs.first[idx][i] * cards.get().embeddings[idx];
+                    }
+                    l2_normalize(pool_embeddings[i]);
                 }
-                l2_normalize(pool_embeddings[i]);
             }
+            pool_transposed = transpose_embeddings(pool_embeddings);
         }
     };
 
-    std::vector<int> test_recognized(std::vector<std::string> oracle_ids) {
+    inline std::vector<int> test_recognized(const std::vector<std::string>& oracle_ids) {
         std::vector<int> result;
         result.reserve(oracle_ids.size());
         for (const std::string& oracle_id : oracle_ids) {
-            result.push_back((details::card_lookups.find(oracle_id) != details::card_lookups.end()) ? 1 : 0);
+            result.push_back((details::card_table.find(oracle_id) != details::CardTable::NOT_FOUND) ? 1 : 0);
         }
         return result;
     }
 
+    namespace details {
+        // Why a pick can not be calculated, or nullptr if it can. Card indices have to be in range of
+        // card_oracle_ids, option entries are positions in cards_in_pack, and pack_num and pick_num have to be before
+        // the end of the draft since they select the oracle weights.
+        inline auto invalid_pick_reason(const DrafterState& drafter_state, const std::vector<Option>& options) noexcept
+                -> const char* {
+            const auto in_range = [](const std::vector<unsigned int>& indices, std::size_t size) {
+                return std::ranges::all_of(indices, [size](unsigned int idx) { return idx < size; });
+            };
+            const std::size_t num_cards = drafter_state.card_oracle_ids.size();
+            if (!in_range(drafter_state.picked, num_cards) || !in_range(drafter_state.seen, num_cards)
+                || !in_range(drafter_state.cards_in_pack, num_cards) || !in_range(drafter_state.basics, num_cards)) {
+                return "A card index is out of range of cardOracleIds.";
+            }
+            for (const Option& option : options) {
+                if (!in_range(option, drafter_state.cards_in_pack.size())) return "An option is out of range of cardsInPack.";
+            }
+            if (drafter_state.pack_num >= drafter_state.num_packs) return "packNum has to be less than numPacks.";
+            if (drafter_state.pick_num >= drafter_state.num_picks) return "pickNum has to be less than numPicks.";
+            return nullptr;
+        }
+
+        inline auto get_weighted_coords(const DrafterState& drafter_state) -> std::pair<Weighted<Coord>, Weighted<Coord>> {
+            const float packFloat = WEIGHT_Y_DIM * static_cast<float>(drafter_state.pack_num) / drafter_state.num_packs;
+            const float pickFloat = WEIGHT_X_DIM * static_cast<float>(drafter_state.pick_num) / drafter_state.num_picks;
+            const std::size_t packLower = static_cast<std::size_t>(packFloat);
+            const std::size_t pickLower = static_cast<std::size_t>(pickFloat);
+            const std::size_t packUpper = std::min(packLower + 1, WEIGHT_Y_DIM - 1);
+            const std::size_t pickUpper = std::min(pickLower + 1, WEIGHT_X_DIM - 1);
+            return { {packFloat - packLower, {pickLower, packLower}}, {pickFloat - pickLower, { pickUpper, packUpper } }};
+        }
+
+        // Adds a card to the sums of a column. Cards without an embedding have a zero normalized embedding, so they
+        // only count towards the probabilities.
+        inline void add_to_column(ColumnAggregates& column, const CardValues& cards, std::size_t idx, float prob,
+                                  bool picked) noexcept {
+            if (picked) {
+                column.pool_embedding += prob * cards.embeddings[idx];
+                column.picked_directions += prob * cards.normalized_embeddings[idx];
+                column.picked_probs += prob;
+                column.picked_ratings += cards.ratings[idx] * prob;
+            } else {
+                column.seen_directions += prob * cards.normalized_embeddings[idx];
+                column.seen_probs += prob;
+                column.seen_ratings += cards.ratings[idx] * prob;
+            }
+        }
+
+        // The sums over picked and seen for every land combination of bot_state.land_combs. With these the pool
+        // oracles are a few dot products per land combination instead of one per card.
+        MTGDRAFTBOTS_TARGET_CLONES
+        inline auto aggregate_pool(const BotState& bot_state) noexcept -> PoolAggregates {
+            PoolAggregates aggregates;
+            for (std::size_t i = 0; i < NUM_LAND_COMBS; i++) aggregates.columns[i].lands = bot_state.land_combs.second[i];
+            for (const auto idx : bot_state.picked) {
+                for (std::size_t i = 0; i < NUM_LAND_COMBS; i++) {
+                    add_to_column(aggregates.columns[i], bot_state.cards, idx, bot_state.land_combs.first[idx][i], true);
+                }
+            }
+            for (const auto idx : bot_state.seen) {
+                for (std::size_t i = 0; i < NUM_LAND_COMBS; i++) {
+                    add_to_column(aggregates.columns[i], bot_state.cards, idx, bot_state.land_combs.first[idx][i], false);
+                }
+            }
+            aggregates.num_picked = bot_state.picked.size();
+            aggregates.num_seen = bot_state.seen.size();
+            return aggregates;
+        }
+
+        // Runs the oracles over a fully prepared bot state and fills in the scores and chosen option of result. This
+        // is the reference for score_options, which computes the same result through score_kernel.
+        inline void score_options_with_oracles(const BotState& bot_state, BotResult& result) {
+            const std::vector<Option>& options = bot_state.options;
+            std::vector<OracleMultiResult> oracle_results;
+            oracle_results.reserve(ORACLES.size());
+            result.scores.reserve(options.size());
+            std::transform(std::begin(ORACLES), std::end(ORACLES), std::back_inserter(oracle_results),
+                           [&](const auto& oracle) { return oracle->calculate_result(bot_state); });
+            for (std::size_t i = 0; i < options.size(); i++) {
+                std::array<float, NUM_LAND_COMBS> scores = { 0.f };
+                for (const auto& oracle_result : oracle_results) scores += oracle_result.weight * oracle_result.value[i];
+                std::size_t best_index = 0;
+                float best_score = scores[0];
+                for (std::size_t j = 1; j < NUM_LAND_COMBS; j++) {
+                    if (scores[j] > best_score) {
+                        best_index = j;
+                        best_score = scores[j];
+                    }
+                }
+                float total_weight = 0.f;
+                for (const auto& oracle_result : oracle_results) total_weight += oracle_result.weight;
+                std::vector<OracleResult> best_oracle_results;
+                best_oracle_results.reserve(ORACLES.size());
+                for (std::size_t j = 0; j < ORACLES.size(); j++) {
+                    std::vector<float> per_card;
+                    per_card.reserve(oracle_results[j].per_card[i].size());
+                    for (const auto& scores : oracle_results[j].per_card[i]) per_card.push_back(scores[best_index]);
+                    OracleResult oracle_result{
+                        oracle_results[j].title,
+                        oracle_results[j].tooltip,
+                        oracle_results[j].weight / total_weight,
+                        oracle_results[j].value[i][best_index],
+                        std::move(per_card),
+                    };
+                    // This filters everything that would show up as 0.00%.
+                    if (oracle_result.weight >= 0.0001 * total_weight) {
+                        best_oracle_results.push_back(oracle_result);
+                    }
+                }
+                result.scores.push_back({ best_score / total_weight, std::move(best_oracle_results), bot_state.land_combs.second[best_index] });
+            }
+            std::size_t best_option = 0;
+            float best_result = -1;
+            for (std::size_t i = 0; i < result.scores.size(); i++) {
+                if (result.scores[i].score > best_result) {
+                    best_option = i;
+                    best_result = result.scores[i].score;
+                }
+            }
+            result.chosen_option = best_option;
+        }
+
+        // Builds the full per option breakdown, with an OracleResult for each oracle, from the output of score_kernel.
+        inline auto explain_scores(const ScoreBuffers& buffers) -> std::vector<BotScore> {
+            std::vector<BotScore> scores;
+            scores.reserve(buffers.num_options);
+            for (std::size_t i = 0; i < buffers.num_options; i++) {
+                const std::size_t best_index = buffers.best_lands[i];
+                const std::size_t first_card = buffers.option_offsets[i];
+                const std::size_t num_cards = buffers.option_offsets[i + 1] - first_card;
+                std::vector<OracleResult> best_oracle_results;
+                best_oracle_results.reserve(NUM_ORACLES);
+                for (std::size_t j = 0; j < NUM_ORACLES; j++) {
+                    const float weight = buffers.weights[j] / buffers.total_weight;
+                    // This filters everything that would show up as 0.00%.
+                    if (!(weight >= 0.0001 * buffers.total_weight)) continue;
+                    const float value = buffers.values[i * NUM_ORACLES + j][best_index];
+                    std::vector<float> per_card;
+                    if (j == RATING_ORACLE || j == PICK_SYNERGY_ORACLE) {
+                        const auto& card_scores = j == RATING_ORACLE ? buffers.rating_per_card : buffers.pick_synergy_per_card;
+                        per_card.reserve(num_cards);
+                        for (std::size_t k = 0; k < num_cards; k++) per_card.push_back(card_scores[first_card + k][best_index]);
+                    } else {
+                        per_card.push_back(value);
+                    }
+                    best_oracle_results.push_back({ std::string(ORACLES[j]->title), std::string(ORACLES[j]->tooltip),
+                                                    weight, value, std::move(per_card) });
+                }
+                scores.push_back({ buffers.best_scores[i], std::move(best_oracle_results), buffers.land_combs[best_index] });
+            }
+            return scores;
+        }
+
+        // Fills in the scores and chosen option of result from score_kernel. buffers can be kept across picks so the
+        // kernel itself does not allocate.
+        inline void score_options(const BotState& bot_state, BotResult& result, ScoreBuffers& buffers) {
+            score_kernel(bot_state, buffers);
+            result.scores = explain_scores(buffers);
+            result.chosen_option = static_cast<unsigned int>(buffers.chosen_option);
+        }
+
+        inline void score_options(const BotState& bot_state, BotResult& result) {
+            ScoreBuffers buffers;
+            score_options(bot_state, result, buffers);
+        }
+
+        // Scores the options into buffers and hands them to the explanation of the result. buffers is only written
+        // to when no earlier explanation still refers to it, otherwise a new one takes its place.
+        inline auto score_options_lean(const BotState& bot_state, std::shared_ptr<ScoreBuffers>& buffers) -> LeanBotResult {
+            if (buffers == nullptr || buffers.use_count() > 1) buffers = std::make_shared<ScoreBuffers>();
+            score_kernel(bot_state, *buffers);
+            LeanBotResult result{ static_cast<unsigned int>(buffers->chosen_option), {}, {}, PickExplanation(buffers) };
+            result.scores.reserve(buffers->num_options);
+            result.lands.reserve(buffers->num_options);
+            for (std::size_t i = 0; i < buffers->num_options; i++) {
+                result.scores.push_back(buffers->best_scores[i]);
+                result.lands.push_back(buffers->land_combs[buffers->best_lands[i]]);
+            }
+            return result;
+        }
+    }
+
+    inline auto PickExplanation::explain() const -> std::vector<BotScore> {
+        if (buffers == nullptr) return {};
+        return details::explain_scores(*buffers);
+    }
+
+    // Scores the options for one drafter against card values that were already resolved from card_oracle_ids.
+    // This lets callers that share one card list between many drafters resolve it only once.
+    inline auto calculate_pick_with_cards(const DrafterState& drafter_state, const std::vector<Option>& options,
+                                          const details::CardValues& cards, std::vector<int> recognized) -> BotResult {
+        BotResult result{ drafter_state, options, std::move(recognized), {}, 0 };
+        details::BotState bot_state{
+            drafter_state,
+            options,
+            details::generate_probs(drafter_state, cards),
+            details::get_weighted_coords(drafter_state),
+            std::cref(cards),
+        };
+        const details::PoolAggregates aggregates = details::aggregate_pool(bot_state);
+        bot_state.aggregates = &aggregates;
+        bot_state.calculate_embeddings();
+        details::score_options(bot_state, result);
+        return result;
+    }
+
     inline auto calculate_pick_from_options(const DrafterState& drafter_state, const std::vector<Option>& options) -> BotResult {
-        using namespace mtgdraftbots::details;
-        const float packFloat = details::WEIGHT_Y_DIM * static_cast<float>(drafter_state.pack_num) / drafter_state.num_packs;
-        const float pickFloat = details::WEIGHT_X_DIM * static_cast<float>(drafter_state.pick_num) / drafter_state.num_picks;
-        const std::size_t packLower = static_cast<std::size_t>(packFloat);
-        const std::size_t pickLower = static_cast<std::size_t>(pickFloat);
-        const std::size_t packUpper = std::min(packLower + 1, details::WEIGHT_Y_DIM - 1);
-        const std::size_t pickUpper = std::min(pickLower + 1, details::WEIGHT_X_DIM - 1);
-        BotResult result{ drafter_state, options, test_recognized(drafter_state.card_oracle_ids) };
-        details::CardValues cards(drafter_state.card_oracle_ids);
+        const details::CardValues cards(drafter_state.card_oracle_ids);
+        return calculate_pick_with_cards(drafter_state, options, cards, test_recognized(drafter_state.card_oracle_ids));
+    }
+
+    // Like calculate_pick_with_cards but returns a LeanBotResult, leaving the oracle breakdown to the explanation.
+    inline auto calculate_lean_pick_with_cards(const DrafterState& drafter_state, const std::vector<Option>& options,
+                                               const details::CardValues& cards) -> LeanBotResult {
         details::BotState bot_state{
             drafter_state,
             options,
             details::generate_probs(drafter_state, cards),
-            { {packFloat - packLower, {pickLower, packLower}}, {pickFloat - pickLower, { pickUpper, packUpper } }},
+            details::get_weighted_coords(drafter_state),
             std::cref(cards),
         };
+        const details::PoolAggregates aggregates = details::aggregate_pool(bot_state);
+        bot_state.aggregates = &aggregates;
         bot_state.calculate_embeddings();
-        std::vector<details::OracleMultiResult> oracle_results;
-        oracle_results.reserve(details::ORACLES.size());
-        result.scores.reserve(options.size());
-        std::transform(std::begin(details::ORACLES), std::end(details::ORACLES), std::back_inserter(oracle_results),
-                       [&](const auto& oracle) { return oracle->calculate_result(bot_state); });
-        for (std::size_t i = 0; i < options.size(); i++) {
-            std::array<float, details::NUM_LAND_COMBS> scores = { 0.f };
-            for (const auto& oracle_result : oracle_results) scores += oracle_result.weight * oracle_result.value[i];
-            std::size_t best_index = 0;
-            float best_score = scores[0];
-            for (std::size_t j = 1; j < NUM_LAND_COMBS; j++) {
-                if (scores[j] > best_score) {
-                    best_index = j;
-                    best_score = scores[j];
+        std::shared_ptr<details::ScoreBuffers> buffers;
+        return details::score_options_lean(bot_state, buffers);
+    }
+
+    inline auto calculate_lean_pick_from_options(const DrafterState& drafter_state, const std::vector<Option>& options) -> LeanBotResult {
+        const details::CardValues cards(drafter_state.card_oracle_ids);
+        return calculate_lean_pick_with_cards(drafter_state, options, cards);
+    }
+
+    namespace details {
+        inline auto hash_oracle_ids(const std::vector<std::string>& card_oracle_ids) noexcept -> std::uint64_t {
+            std::uint64_t result = card_oracle_ids.size();
+            for (const std::string& oracle_id : card_oracle_ids) result = hash_combine(result, std::hash<std::string>{}(oracle_id));
+            return result;
+        }
+
+        // Calls score_seat(seat, cards, recognized) for every seat. Seats whose get_oracle_ids(seat) are the same
+        // (by far the common case) share one resolved card list. With num_threads > 1 the seats are scored
+        // concurrently, on builds that have threads available. The first exception score_seat throws is rethrown
+        // once every thread has stopped, seats not started by then are skipped.
+        template <typename GetOracleIds, typename ScoreSeat>
+        inline void score_seats(std::size_t num_seats, GetOracleIds&& get_oracle_ids, ScoreSeat&& score_seat,
+                                std::size_t num_threads) {
+            if (num_seats == 0) return;
+            // Only the resolved card lists are shared, every seat still generates its own land combinations and
+            // runs its own scoring. Each list is hashed once, the lists are only compared when their hashes match.
+            std::vector<CardValues> card_values;
+            std::vector<std::vector<int>> recognized;
+            std::vector<std::pair<std::uint64_t, std::size_t>> representatives;
+            std::vector<std::size_t> card_values_index(num_seats);
+            for (std::size_t seat = 0; seat < num_seats; seat++) {
+                const std::vector<std::string>& card_oracle_ids = get_oracle_ids(seat);
+                const std::uint64_t hash = hash_oracle_ids(card_oracle_ids);
+                auto iter = std::find_if(std::begin(representatives), std::end(representatives), [&](const auto& other) {
+                    return other.first == hash && get_oracle_ids(other.second) == card_oracle_ids;
+                });
+                card_values_index[seat] = static_cast<std::size_t>(std::distance(std::begin(representatives), iter));
+                if (iter == std::end(representatives)) {
+                    representatives.emplace_back(hash, seat);
+                    card_values.emplace_back(card_oracle_ids);
+                    recognized.push_back(test_recognized(card_oracle_ids));
                 }
             }
-            float total_weight = 0.f;
-            for (const auto& oracle_result : oracle_results) total_weight += oracle_result.weight;
-            std::vector<OracleResult> best_oracle_results;
-            best_oracle_results.reserve(details::ORACLES.size());
-            for (std::size_t j = 0; j < details::ORACLES.size(); j++) {
-                std::vector<float> per_card;
-                per_card.reserve(oracle_results[j].per_card[i].size());
-                for (const auto& scores : oracle_results[j].per_card[i]) per_card.push_back(scores[best_index]);
-                OracleResult oracle_result{
-                    oracle_results[j].title,
-                    oracle_results[j].tooltip,
-                    oracle_results[j].weight / total_weight,
-                    oracle_results[j].value[i][best_index],
-                    std::move(per_card),
-                };
-                // This filters everything that would show up as 0.00%.
-                if (oracle_result.weight >= 0.0001 * total_weight) {
-                    best_oracle_results.push_back(oracle_result);
+            const auto score_one = [&](std::size_t seat) {
+                const std::size_t index = card_values_index[seat];
+                score_seat(seat, card_values[index], recognized[index]);
+            };
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+            static_cast<void>(num_threads);
+            for (std::size_t seat = 0; seat < num_seats; seat++) score_one(seat);
+#else
+            num_threads = std::clamp<std::size_t>(num_threads, 1, num_seats);
+            std::atomic<std::size_t> next_seat{ 0 };
+            std::exception_ptr error;
+            std::mutex error_mutex;
+            // An exception leaving a std::jthread terminates, so it is kept for the caller instead.
+            const auto worker = [&]() {
+                try {
+                    for (std::size_t seat = next_seat++; seat < num_seats; seat = next_seat++) score_one(seat);
+                } catch (...) {
+                    next_seat = num_seats;
+                    const std::lock_guard lock(error_mutex);
+                    if (!error) error = std::current_exception();
                 }
+            };
+            {
+                std::vector<std::jthread> workers;
+                workers.reserve(num_threads - 1);
+                for (std::size_t i = 1; i < num_threads; i++) workers.emplace_back(worker);
+                worker();
             }
-            result.scores.push_back({ best_score / total_weight, std::move(best_oracle_results), bot_state.land_combs.second[best_index] });
-        }
-        std::size_t best_option = 0;
-        float best_result = -1;
-        for (std::size_t i = 0; i < result.scores.size(); i++) {
-            if (result.scores[i].score > best_result) {
-                best_option = i;
-                best_result = result.scores[i].score;
-            }
+            if (error) std::rethrow_exception(error);
+#endif
         }
-        result.chosen_option = best_option;
-        return result;
     }
 
-    inline void initialize_draftbots(const std::vector<char>& buffer) {
-        const char* cur_pos = buffer.data();
-        for (std::size_t i = 0; i < details::embedding_bias.size(); i++) {
-            details::embedding_bias[i] = *reinterpret_cast<const float*>(cur_pos);
-            cur_pos += sizeof(float);
-        }
-        std::uint8_t num_oracles = *reinterpret_cast<const std::uint8_t*>(cur_pos);
-        cur_pos += sizeof(std::uint8_t);
-        details::weights_map.clear();
-        for (std::size_t i = 0; i < num_oracles; i++) {
-            details::Weights weights;
-            for (std::size_t x = 0; x < details::WEIGHT_X_DIM; x++) {
-                for (std::size_t y = 0; y < details::WEIGHT_Y_DIM; y++) {
-                    weights[x][y] = *reinterpret_cast<const float*>(cur_pos);
-                    cur_pos += sizeof(float);
-                }
-            }
-            std::size_t length = std::strlen(cur_pos);
-            std::string title(cur_pos, cur_pos + length);
-            cur_pos += length + 1;
-            details::weights_map.insert({ title, weights });
-        }
-        details::card_lookups.clear();
-        // std::cout << __LINE__ << ": " << cur_pos - buffer.data() << std::endl;
-        std::uint32_t num_cards = *reinterpret_cast<const std::uint32_t*>(cur_pos);
-        // WASM is 32 bit by default, but this is saved as 64.
-        cur_pos += sizeof(std::uint32_t);
-        for (std::size_t i = 0; i < num_cards; i++) {
-            // std::cout << __LINE__ << ": " << cur_pos - buffer.data() << ' ' << num_cards << std::endl;
-            float rating = *reinterpret_cast<const float*>(cur_pos);
-            // std::cout << __LINE__ << ": " << cur_pos - buffer.data() << std::endl;
-            cur_pos += sizeof(float);
-            // std::cout << __LINE__ << ": " << cur_pos - buffer.data() << std::endl;
-            details::Embedding embedding;
-            for (std::size_t j = 0; j < embedding.size(); j++) {
-                embedding[j] = *reinterpret_cast<const float*>(cur_pos);
-                cur_pos += sizeof(float);
-            }
-            // std::cout << __LINE__ << ": " << cur_pos - buffer.data() << std::endl;
-			std::uint8_t produces = *reinterpret_cast<const std::uint8_t*>(cur_pos);
-			cur_pos += sizeof(std::uint8_t);
-            // std::cout << __LINE__ << ": " << cur_pos - buffer.data() << std::endl;
-            std::uint8_t cmc = *reinterpret_cast<const std::uint8_t*>(cur_pos);
-            cur_pos += sizeof(std::uint8_t);
-            // std::cout << __LINE__ << ": " << cur_pos - buffer.data() << std::endl;
-            std::uint8_t num_symbols = *reinterpret_cast<const std::uint8_t*>(cur_pos);
-            cur_pos += sizeof(std::uint8_t);
-            // std::cout << __LINE__ << ": " << cur_pos - buffer.data() <<  ' ' << static_cast<std::size_t>(num_symbols) << std::endl;
-            std::vector<std::string> symbols;
-            symbols.reserve(num_symbols);
-            for (std::size_t j = 0; j < num_symbols; j++) {
-                symbols.emplace_back(cur_pos, cur_pos + 3);
-                cur_pos += 3;
-            }
-            details::CardCost cost(cmc, symbols);
-            // They're UUID's so 36 is always the length
-            std::string oracle_id(cur_pos, cur_pos + 36);
-            cur_pos += 36;
-            details::card_lookups.insert({ oracle_id, details::CardValue{ rating, embedding, cost, produces } });
+    // Calculates the picks for many drafters at once, e.g. every seat at a table. Drafters that share the same
+    // card_oracle_ids only have that list resolved once, past that every drafter is scored on its own exactly like
+    // calculate_pick_from_options would, num_threads of them at a time. options[i] are the options of
+    // drafter_states[i], so both have to be the same length. Throws whatever scoring a drafter throws.
+    inline auto calculate_picks_batch(std::span<const DrafterState> drafter_states,
+                                      std::span<const std::vector<Option>> options,
+                                      std::size_t num_threads = 1) -> std::vector<BotResult> {
+        if (drafter_states.size() != options.size()) {
+            throw std::invalid_argument("calculate_picks_batch needs one list of options per drafter state.");
         }
+        const std::size_t num_seats = drafter_states.size();
+        std::vector<BotResult> results(num_seats);
+        details::score_seats(
+            num_seats, [&](std::size_t seat) -> const std::vector<std::string>& { return drafter_states[seat].card_oracle_ids; },
+            [&](std::size_t seat, const details::CardValues& cards, const std::vector<int>& recognized) {
+                results[seat] = calculate_pick_with_cards(drafter_states[seat], options[seat], cards, recognized);
+            },
+            num_threads);
+        return results;
+    }
+
+    // Accepts both the legacy params format and the versioned format described in details/params.hpp. The versioned
+    // format is used in place so the buffer is kept alive for as long as the params stay loaded.
+    inline bool initialize_draftbots(std::shared_ptr<const std::vector<char>> buffer) {
+        const std::span<const char> bytes(*buffer);
+        return details::load_params(bytes, std::move(buffer));
+    }
+
+    inline bool initialize_draftbots(std::vector<char>&& buffer) {
+        return initialize_draftbots(std::make_shared<const std::vector<char>>(std::move(buffer)));
+    }
+
+    inline bool initialize_draftbots(const std::vector<char>& buffer) {
+        if (details::is_versioned_params(buffer)) return initialize_draftbots(std::make_shared<const std::vector<char>>(buffer));
+        else return details::load_legacy_params(buffer);
+    }
+
+    // On native builds versioned params files are memory mapped so loading them is nearly free and the pages are
+    // shared between processes.
+    inline bool initialize_draftbots_from_file(const std::string& path) {
+        auto [bytes, storage] = details::map_params_file(path);
+        if (bytes.empty()) {
+            std::cerr << "Could not read the params file " << path << '.' << std::endl;
+            return false;
+        }
+        return details::load_params(bytes, std::move(storage));
+    }
+
+    // The probability table is otherwise filled slab by slab as card lists need it, this fills all of it up front on
+    // num_threads so e.g. a service does not pay for it on its first requests. On native builds the trained table is
+    // read first (see details::default_prob_table_path), and only what it leaves out is generated. A cache_path keeps
+    // the generated table on disk, it is read from there if it was written before and generated and written there
+    // otherwise.
+    inline bool initialize_prob_table(std::size_t num_threads = 1, [[maybe_unused]] const std::string& cache_path = {}) {
+#if !defined(__EMSCRIPTEN__)
+        details::prob_table.load_trained();
+        if (!cache_path.empty()) {
+            if (details::prob_table.load(cache_path) || details::prob_table.save(cache_path, num_threads)) return true;
+            std::cerr << "Could not write the probability table cache " << cache_path << '.' << std::endl;
+            return false;
+        }
+#endif
+        details::prob_table.ensure_all(num_threads);
+        return true;
     }
 }
 #endif
@@ -129,9 +129,10 @@ namespace mtgdraftbots {
                                 score_for_option.push_back({ 0 });
                             }
                             else {
+                                const std::array<float, NUM_LAND_COMBS> dots = dot_block(card_embed, bot_state.pool_transposed);
                                 std::array<float, NUM_LAND_COMBS> score_for_card;
                                 for (std::size_t i = 0; i < 8; i++) {
-                                    score_for_card[i] = bot_state.land_combs.first[idx][i] * (card_embed * bot_state.pool_embeddings[i] / std::sqrt(norm) + 1.f) / 2.f;
+                                    score_for_card[i] = bot_state.land_combs.first[idx][i] * (dots[i] / std::sqrt(norm) + 1.f) / 2.f;
                                 }
                                 score_for_option.push_back(score_for_card);
                             }
@@ -148,6 +149,14 @@ namespace mtgdraftbots {
             protected:
                 inline OracleScores calculate_values(const BotState& bot_state) const noexcept override {
                     std::array<float, NUM_LAND_COMBS> scores{ 0.f };
+                    if (bot_state.aggregates != nullptr) {
+                        for (std::size_t i = 0; i < NUM_LAND_COMBS; i++) {
+                            const ColumnAggregates& column = bot_state.aggregates->columns[i];
+                            scores[i] = (column.picked_directions * bot_state.pool_embeddings[i] + column.picked_probs) / 2.f;
+                        }
+                        if (bot_state.picked.size() > 0)  scores /= static_cast<float>(bot_state.picked.size());
+                        return OracleScores(bot_state.options.size(), OracleScore(1, scores));
+                    }
                     for (const auto idx : bot_state.picked) {
                         const Embedding& card_embed = bot_state.cards.get().embeddings[idx];
                         float norm = card_embed * card_embed;
@@ -155,8 +164,9 @@ namespace mtgdraftbots {
                             scores += 0.5f * bot_state.land_combs.first[idx];
                         }
                         else {
+                            const std::array<float, NUM_LAND_COMBS> dots = dot_block(card_embed, bot_state.pool_transposed);
                             for (std::size_t i = 0; i < NUM_LAND_COMBS; i++) {
-                                scores[i] += bot_state.land_combs.first[idx][i] * (card_embed * bot_state.pool_embeddings[i] / std::sqrt(norm) + 1.f) / 2.f;
+                                scores[i] += bot_state.land_combs.first[idx][i] * (dots[i] / std::sqrt(norm) + 1.f) / 2.f;
                             }
                         }
                     }
@@ -171,9 +181,13 @@ namespace mtgdraftbots {
             protected:
                 inline OracleScores calculate_values(const BotState& bot_state) const noexcept override {
                     std::array<float, NUM_LAND_COMBS> scores{ 0.f };
-                    for (const auto idx : bot_state.picked) {
-                        const float rating = bot_state.cards.get().ratings[idx];
-                        scores += rating * bot_state.land_combs.first[idx];
+                    if (bot_state.aggregates != nullptr) {
+                        for (std::size_t i = 0; i < NUM_LAND_COMBS; i++) scores[i] = bot_state.aggregates->columns[i].picked_ratings;
+                    } else {
+                        for (const auto idx : bot_state.picked) {
+                            const float rating = bot_state.cards.get().ratings[idx];
+                            scores += rating * bot_state.land_combs.first[idx];
+                        }
                     }
                     if (bot_state.picked.size() > 0)  scores /= static_cast<float>(bot_state.picked.size());
                     return OracleScores(bot_state.options.size(), OracleScore(1, scores));
@@ -186,6 +200,14 @@ namespace mtgdraftbots {
             protected:
                 inline OracleScores calculate_values(const BotState& bot_state) const noexcept override {
                     std::array<float, NUM_LAND_COMBS> scores{ 0.f };
+                    if (bot_state.aggregates != nullptr) {
+                        for (std::size_t i = 0; i < NUM_LAND_COMBS; i++) {
+                            const ColumnAggregates& column = bot_state.aggregates->columns[i];
+                            scores[i] = (column.seen_directions * bot_state.pool_embeddings[i] + column.seen_probs) / 2.f;
+                        }
+                        if (bot_state.seen.size() > 0)  scores /= static_cast<float>(bot_state.seen.size());
+                        return OracleScores(bot_state.options.size(), OracleScore(1, scores));
+                    }
                     for (const auto idx : bot_state.seen) {
                         const Embedding& card_embed = bot_state.cards.get().embeddings[idx];
                         float norm = card_embed * card_embed;
@@ -193,8 +215,9 @@ namespace mtgdraftbots {
                             scores += 0.5f * bot_state.land_combs.first[idx];
                         }
                         else {
+                            const std::array<float, NUM_LAND_COMBS> dots = dot_block(card_embed, bot_state.pool_transposed);
                             for (std::size_t i = 0; i < NUM_LAND_COMBS; i++) {
-                                scores[i] += bot_state.land_combs.first[idx][i] * (card_embed * bot_state.pool_embeddings[i] / std::sqrt(norm) + 1.f) / 2.f;
+                                scores[i] += bot_state.land_combs.first[idx][i] * (dots[i] / std::sqrt(norm) + 1.f) / 2.f;
                             }
                         }
                     }
@@ -209,9 +232,13 @@ namespace mtgdraftbots {
             protected:
                 inline OracleScores calculate_values(const BotState& bot_state) const noexcept override {
                     std::array<float, NUM_LAND_COMBS> scores{ 0.f };
-                    for (const auto idx : bot_state.seen) {
-                        const float rating = bot_state.cards.get().ratings[idx];
-                        scores += rating * bot_state.land_combs.first[idx];
+                    if (bot_state.aggregates != nullptr) {
+                        for (std::size_t i = 0; i < NUM_LAND_COMBS; i++) scores[i] = bot_state.aggregates->columns[i].seen_ratings;
+                    } else {
+                        for (const auto idx : bot_state.seen) {
+                            const float rating = bot_state.cards.get().ratings[idx];
+                            scores += rating * bot_state.land_combs.first[idx];
+                        }
                     }
                     if (bot_state.seen.size() > 0)  scores /= static_cast<float>(bot_state.seen.size());
                     return OracleScores(bot_state.options.size(), OracleScore(1, scores));
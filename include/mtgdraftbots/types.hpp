@@ -36,12 +36,37 @@ namespace mtgdraftbots {
 
         constexpr std::size_t NUM_LAND_COMBS = 8;
 
+        // Sums over the picked and seen cards for a single land combination. The probabilities of a card only depend
+        // on its cost and the lands, so while a land combination stays the same these can be extended card by card.
+        struct ColumnAggregates {
+            Lands lands{ 0 };
+            // Sum of probability times embedding over picked, without the bias.
+            Embedding pool_embedding{ 0 };
+            // Sum of probability times the normalized embedding, cards without an embedding contribute nothing.
+            Embedding picked_directions{ 0 };
+            Embedding seen_directions{ 0 };
+            float picked_probs{ 0 };
+            float seen_probs{ 0 };
+            float picked_ratings{ 0 };
+            float seen_ratings{ 0 };
+        };
+
+        struct PoolAggregates {
+            std::array<ColumnAggregates, NUM_LAND_COMBS> columns;
+            std::size_t num_picked{ 0 };
+            std::size_t num_seen{ 0 };
+        };
+
         struct BotState : public DrafterState {
             std::vector<Option> options;
             std::pair<std::vector<std::array<float, NUM_LAND_COMBS>>, std::array<Lands, NUM_LAND_COMBS>> land_combs;
             std::pair<Weighted<Coord>, Weighted<Coord>> weighted_coords;
             std::reference_wrapper<const CardValues> cards;
             std::array<Embedding, NUM_LAND_COMBS> pool_embeddings{ embedding_bias };
+            // pool_embeddings laid out for dot_block.
+            TransposedEmbeddings<NUM_LAND_COMBS> pool_transposed{ {{ 0.f }} };
+            // When set these must cover all of picked and seen for the current land_combs.
+            const PoolAggregates* aggregates{ nullptr };
 
             constexpr void calculate_embeddings() & noexcept;
         };
@@ -0,0 +1,358 @@
+#ifndef MTGDRAFTBOTS_WIRE_HPP
+#define MTGDRAFTBOTS_WIRE_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mtgdraftbots/mtgdraftbots.hpp"
+
+namespace mtgdraftbots {
+    // A pick to calculate as it crosses a process or worker boundary. Without explain the result is built from a
+    // LeanBotResult and carries no oracle breakdown.
+    struct PickRequest {
+        DrafterState drafter_state;
+        std::vector<Option> options;
+        bool explain{ true };
+    };
+
+    // Binary encoding of PickRequest and BotResult/LeanBotResult. Every message is a header of uint32 fields
+    // followed by flat arrays, each starting on a 4 byte boundary, so a reader can view any of them in place as a
+    // typed array. The result does not echo the DrafterState or options, the caller already has them. All values
+    // are little endian.
+    //
+    // Request: magic, version, flags, pack_num, num_packs, pick_num, num_picks, seed, num_picked, num_seen,
+    //          num_cards_in_pack, num_basics, num_options, num_option_cards, num_oracle_ids, then
+    //          picked, seen, cards_in_pack, basics (uint32 each), option_offsets (num_options + 1 uint32),
+    //          option_cards (uint32), oracle_id_offsets (num_oracle_ids + 1 uint32) and the UTF-8 oracle ids.
+    // Result:  magic, version, flags, chosen_option, num_options, num_recognized, num_oracle_results, num_titles,
+    //          then scores (float per option), lands (32 bytes per option), recognized (uint8 per card),
+    //          and with WIRE_EXPLAIN: result_offsets (num_options + 1 uint32), title_indices (uint32),
+    //          weights and values (float per oracle result), per_card_offsets (num_oracle_results + 1 uint32),
+    //          per_card (float), title_offsets (2 * num_titles + 1 uint32) and the UTF-8 titles and tooltips.
+    // Batch:   magic, version, count, then count + 1 uint32 byte offsets from the start of the batch and the messages
+    //          themselves, each an ordinary request or result. A request that was rejected gets an empty result.
+    constexpr std::uint32_t WIRE_REQUEST_MAGIC = 0x5142444D; // "MDBQ"
+    constexpr std::uint32_t WIRE_RESULT_MAGIC = 0x5242444D; // "MDBR"
+    constexpr std::uint32_t WIRE_BATCH_MAGIC = 0x4242444D; // "MDBB"
+    constexpr std::uint32_t WIRE_VERSION = 1;
+    constexpr std::uint32_t WIRE_EXPLAIN = 1;
+
+    static_assert(std::endian::native == std::endian::little, "The wire format is read and written in place.");
+
+    namespace details {
+        struct WireWriter {
+            std::vector<std::uint8_t> bytes;
+
+            void write_u32(std::uint32_t value) { write_bytes(&value, sizeof(value)); }
+
+            template <typename T>
+            void write_array(std::span<const T> values) { write_bytes(values.data(), values.size_bytes()); }
+
+            void write_bytes(const void* data, std::size_t size) {
+                const std::size_t start = bytes.size();
+                bytes.resize(start + size);
+                if (size > 0) std::memcpy(bytes.data() + start, data, size);
+            }
+
+            void pad() { bytes.resize((bytes.size() + 3) & ~std::size_t{ 3 }, 0); }
+
+            // Offsets into one UTF-8 blob, so the reader can slice out any string without scanning.
+            void write_strings(std::span<const std::string_view> strings) {
+                std::uint32_t offset = 0;
+                write_u32(offset);
+                for (const std::string_view str : strings) write_u32(offset += static_cast<std::uint32_t>(str.size()));
+                for (const std::string_view str : strings) write_bytes(str.data(), str.size());
+                pad();
+            }
+        };
+
+        struct WireReader {
+            std::span<const std::uint8_t> bytes;
+            std::size_t position{ 0 };
+
+            bool read_u32(std::uint32_t& value) noexcept { return read_bytes(&value, sizeof(value)); }
+
+            // count is 64 bit so a count read from the message plus one can not wrap where size_t is 32 bit.
+            template <typename T>
+            bool read_array(std::vector<T>& values, std::uint64_t count) {
+                if (count > (bytes.size() - position) / sizeof(T)) return false;
+                values.resize(static_cast<std::size_t>(count));
+                return read_bytes(values.data(), values.size() * sizeof(T));
+            }
+
+            bool read_bytes(void* data, std::size_t size) noexcept {
+                if (size > bytes.size() - position) return false;
+                if (size > 0) std::memcpy(data, bytes.data() + position, size);
+                position += size;
+                return true;
+            }
+
+            bool pad() noexcept {
+                position = (position + 3) & ~std::size_t{ 3 };
+                return position <= bytes.size();
+            }
+
+            bool read_strings(std::vector<std::string>& strings, std::uint32_t count) {
+                std::vector<std::uint32_t> offsets;
+                if (!read_array(offsets, std::uint64_t{ count } + 1) || offsets[0] != 0) return false;
+                const std::size_t start = position;
+                for (std::size_t i = 0; i < count; i++) {
+                    if (offsets[i + 1] < offsets[i] || offsets[i + 1] > bytes.size() - start) return false;
+                }
+                strings.clear();
+                strings.reserve(count);
+                for (std::size_t i = 0; i < count; i++) {
+                    strings.emplace_back(reinterpret_cast<const char*>(bytes.data() + start + offsets[i]),
+                                         offsets[i + 1] - offsets[i]);
+                }
+                position += offsets[count];
+                return pad();
+            }
+        };
+
+        inline void write_options(WireWriter& writer, const std::vector<Option>& options) {
+            std::uint32_t offset = 0;
+            writer.write_u32(offset);
+            for (const Option& option : options) writer.write_u32(offset += static_cast<std::uint32_t>(option.size()));
+            for (const Option& option : options) writer.write_array(std::span<const unsigned int>(option));
+        }
+
+        inline void write_result(WireWriter& writer, std::uint32_t chosen_option, std::span<const float> scores,
+                                 std::span<const Lands> lands, std::span<const int> recognized,
+                                 const std::vector<BotScore>* explanation) {
+            std::vector<std::string_view> titles;
+            std::vector<std::uint32_t> result_offsets{ 0 };
+            std::vector<std::uint32_t> title_indices;
+            std::vector<float> weights;
+            std::vector<float> values;
+            std::vector<std::uint32_t> per_card_offsets{ 0 };
+            std::vector<float> per_card;
+            if (explanation != nullptr) {
+                for (const BotScore& score : *explanation) {
+                    for (const OracleResult& oracle_result : score.oracle_results) {
+                        std::size_t title_index = 0;
+                        while (title_index < titles.size() && titles[title_index] != oracle_result.title) title_index += 2;
+                        if (title_index == titles.size()) {
+                            titles.push_back(oracle_result.title);
+                            titles.push_back(oracle_result.tooltip);
+                        }
+                        title_indices.push_back(static_cast<std::uint32_t>(title_index / 2));
+                        weights.push_back(oracle_result.weight);
+                        values.push_back(oracle_result.value);
+                        per_card.insert(std::end(per_card), std::begin(oracle_result.per_card), std::end(oracle_result.per_card));
+                        per_card_offsets.push_back(static_cast<std::uint32_t>(per_card.size()));
+                    }
+                    result_offsets.push_back(static_cast<std::uint32_t>(title_indices.size()));
+                }
+            }
+            writer.write_u32(WIRE_RESULT_MAGIC);
+            writer.write_u32(WIRE_VERSION);
+            writer.write_u32(explanation != nullptr ? WIRE_EXPLAIN : 0);
+            writer.write_u32(chosen_option);
+            writer.write_u32(static_cast<std::uint32_t>(scores.size()));
+            writer.write_u32(static_cast<std::uint32_t>(recognized.size()));
+            writer.write_u32(static_cast<std::uint32_t>(title_indices.size()));
+            writer.write_u32(static_cast<std::uint32_t>(titles.size() / 2));
+            writer.write_array(scores);
+            writer.write_array(lands);
+            for (const int card_recognized : recognized) writer.bytes.push_back(card_recognized ? 1 : 0);
+            writer.pad();
+            if (explanation == nullptr) return;
+            writer.write_array(std::span<const std::uint32_t>(result_offsets));
+            writer.write_array(std::span<const std::uint32_t>(title_indices));
+            writer.write_array(std::span<const float>(weights));
+            writer.write_array(std::span<const float>(values));
+            writer.write_array(std::span<const std::uint32_t>(per_card_offsets));
+            writer.write_array(std::span<const float>(per_card));
+            writer.write_strings(titles);
+        }
+    }
+
+    inline auto encode_pick_request(const PickRequest& request) -> std::vector<std::uint8_t> {
+        const DrafterState& state = request.drafter_state;
+        std::size_t num_option_cards = 0;
+        for (const Option& option : request.options) num_option_cards += option.size();
+        details::WireWriter writer;
+        for (const std::uint32_t value : {
+                WIRE_REQUEST_MAGIC, WIRE_VERSION, request.explain ? WIRE_EXPLAIN : 0u, state.pack_num, state.num_packs,
+                state.pick_num, state.num_picks, state.seed, static_cast<std::uint32_t>(state.picked.size()),
+                static_cast<std::uint32_t>(state.seen.size()), static_cast<std::uint32_t>(state.cards_in_pack.size()),
+                static_cast<std::uint32_t>(state.basics.size()), static_cast<std::uint32_t>(request.options.size()),
+                static_cast<std::uint32_t>(num_option_cards), static_cast<std::uint32_t>(state.card_oracle_ids.size()) }) {
+            writer.write_u32(value);
+        }
+        writer.write_array(std::span<const unsigned int>(state.picked));
+        writer.write_array(std::span<const unsigned int>(state.seen));
+        writer.write_array(std::span<const unsigned int>(state.cards_in_pack));
+        writer.write_array(std::span<const unsigned int>(state.basics));
+        details::write_options(writer, request.options);
+        const std::vector<std::string_view> oracle_ids(std::begin(state.card_oracle_ids), std::end(state.card_oracle_ids));
+        writer.write_strings(oracle_ids);
+        return std::move(writer.bytes);
+    }
+
+    // Rejects truncated messages and any index that is out of range for the lists it points into. If given, reason
+    // is set to why a message was rejected, it is left to the caller to report it.
+    inline bool decode_pick_request(std::span<const std::uint8_t> bytes, PickRequest& request,
+                                    const char** reason = nullptr) {
+        const auto reject = [reason](const char* why) {
+            if (reason != nullptr) *reason = why;
+            return false;
+        };
+        details::WireReader reader{ bytes };
+        std::uint32_t magic, version, flags, num_picked, num_seen, num_cards_in_pack, num_basics, num_options,
+                      num_option_cards, num_oracle_ids;
+        DrafterState& state = request.drafter_state;
+        if (!reader.read_u32(magic) || magic != WIRE_REQUEST_MAGIC || !reader.read_u32(version) || version != WIRE_VERSION) {
+            return reject("Not a pick request of this wire version.");
+        }
+        std::vector<std::uint32_t> option_offsets;
+        std::vector<unsigned int> option_cards;
+        if (!reader.read_u32(flags) || !reader.read_u32(state.pack_num) || !reader.read_u32(state.num_packs)
+            || !reader.read_u32(state.pick_num) || !reader.read_u32(state.num_picks) || !reader.read_u32(state.seed)
+            || !reader.read_u32(num_picked) || !reader.read_u32(num_seen) || !reader.read_u32(num_cards_in_pack)
+            || !reader.read_u32(num_basics) || !reader.read_u32(num_options) || !reader.read_u32(num_option_cards)
+            || !reader.read_u32(num_oracle_ids) || !reader.read_array(state.picked, num_picked)
+            || !reader.read_array(state.seen, num_seen) || !reader.read_array(state.cards_in_pack, num_cards_in_pack)
+            || !reader.read_array(state.basics, num_basics) || !reader.read_array(option_offsets, std::uint64_t{ num_options } + 1)
+            || !reader.read_array(option_cards, num_option_cards) || !reader.read_strings(state.card_oracle_ids, num_oracle_ids)) {
+            return reject("Truncated pick request.");
+        }
+        request.explain = (flags & WIRE_EXPLAIN) != 0;
+        if (option_offsets[0] != 0 || option_offsets[num_options] != num_option_cards) {
+            return reject("The option offsets do not cover the option cards.");
+        }
+        request.options.clear();
+        request.options.reserve(num_options);
+        for (std::size_t i = 0; i < num_options; i++) {
+            if (option_offsets[i + 1] < option_offsets[i]) return reject("The option offsets are not in order.");
+            request.options.emplace_back(std::begin(option_cards) + option_offsets[i], std::begin(option_cards) + option_offsets[i + 1]);
+        }
+        if (const char* invalid = details::invalid_pick_reason(state, request.options); invalid != nullptr) {
+            return reject(invalid);
+        }
+        return true;
+    }
+
+    inline auto encode_bot_result(const BotResult& result) -> std::vector<std::uint8_t> {
+        std::vector<float> scores;
+        std::vector<Lands> lands;
+        for (const BotScore& score : result.scores) {
+            scores.push_back(score.score);
+            lands.push_back(score.lands);
+        }
+        details::WireWriter writer;
+        details::write_result(writer, result.chosen_option, scores, lands, result.recognized, &result.scores);
+        return std::move(writer.bytes);
+    }
+
+    // The lean result has no recognized list and only carries the oracle breakdown if explain is set, in which case
+    // it is built from the explanation handle.
+    inline auto encode_bot_result(const LeanBotResult& result, bool explain = false) -> std::vector<std::uint8_t> {
+        details::WireWriter writer;
+        if (explain) {
+            const std::vector<BotScore> explanation = result.explanation.explain();
+            details::write_result(writer, result.chosen_option, result.scores, result.lands, {}, &explanation);
+        } else {
+            details::write_result(writer, result.chosen_option, result.scores, result.lands, {}, nullptr);
+        }
+        return std::move(writer.bytes);
+    }
+
+    inline auto calculate_pick_encoded(const PickRequest& request) -> std::vector<std::uint8_t> {
+        if (request.explain) return encode_bot_result(calculate_pick_from_options(request.drafter_state, request.options));
+        return encode_bot_result(calculate_lean_pick_from_options(request.drafter_state, request.options));
+    }
+
+    inline auto encode_batch(std::span<const std::vector<std::uint8_t>> messages) -> std::vector<std::uint8_t> {
+        details::WireWriter writer;
+        writer.write_u32(WIRE_BATCH_MAGIC);
+        writer.write_u32(WIRE_VERSION);
+        writer.write_u32(static_cast<std::uint32_t>(messages.size()));
+        std::uint32_t offset = static_cast<std::uint32_t>(4 * (messages.size() + 4));
+        writer.write_u32(offset);
+        for (const std::vector<std::uint8_t>& message : messages) {
+            writer.write_u32(offset += static_cast<std::uint32_t>((message.size() + 3) & ~std::size_t{ 3 }));
+        }
+        for (const std::vector<std::uint8_t>& message : messages) {
+            writer.write_bytes(message.data(), message.size());
+            writer.pad();
+        }
+        return std::move(writer.bytes);
+    }
+
+    // The messages are views into bytes. If given, reason is set to why the batch was rejected.
+    inline bool decode_batch(std::span<const std::uint8_t> bytes, std::vector<std::span<const std::uint8_t>>& messages,
+                             const char** reason = nullptr) {
+        const auto reject = [reason](const char* why) {
+            if (reason != nullptr) *reason = why;
+            return false;
+        };
+        details::WireReader reader{ bytes };
+        std::uint32_t magic, version, count;
+        std::vector<std::uint32_t> offsets;
+        if (!reader.read_u32(magic) || magic != WIRE_BATCH_MAGIC || !reader.read_u32(version) || version != WIRE_VERSION) {
+            return reject("Not a batch of this wire version.");
+        }
+        if (!reader.read_u32(count) || !reader.read_array(offsets, std::uint64_t{ count } + 1)) {
+            return reject("Truncated batch.");
+        }
+        messages.clear();
+        messages.reserve(count);
+        for (std::size_t i = 0; i < count; i++) {
+            if (offsets[i] < reader.position || offsets[i + 1] < offsets[i] || offsets[i + 1] > bytes.size()) {
+                return reject("A batch offset is out of range.");
+            }
+            messages.push_back(bytes.subspan(offsets[i], offsets[i + 1] - offsets[i]));
+        }
+        return true;
+    }
+
+    // Calculates each encoded request and returns its encoded result, or an empty result if it could not be decoded.
+    // Requests that share a card list only have it resolved once. If given, still_wanted is asked right before each
+    // request is scored and the request is skipped, with an empty result, when it returns false. If given, reasons
+    // gets one entry per message, why it could not be decoded or nullptr.
+    inline auto calculate_picks_encoded(std::span<const std::span<const std::uint8_t>> messages, std::size_t num_threads = 1,
+                                        const std::function<bool(std::size_t)>& still_wanted = {},
+                                        std::vector<const char*>* reasons = nullptr)
+            -> std::vector<std::vector<std::uint8_t>> {
+        std::vector<PickRequest> requests(messages.size());
+        std::vector<std::size_t> valid;
+        if (reasons != nullptr) reasons->assign(messages.size(), nullptr);
+        for (std::size_t i = 0; i < messages.size(); i++) {
+            if (decode_pick_request(messages[i], requests[i], reasons != nullptr ? &(*reasons)[i] : nullptr)) valid.push_back(i);
+        }
+        std::vector<std::vector<std::uint8_t>> results(messages.size());
+        details::score_seats(
+            valid.size(), [&](std::size_t seat) -> const std::vector<std::string>& { return requests[valid[seat]].drafter_state.card_oracle_ids; },
+            [&](std::size_t seat, const details::CardValues& cards, const std::vector<int>& recognized) {
+                const PickRequest& request = requests[valid[seat]];
+                if (still_wanted && !still_wanted(valid[seat])) return;
+                if (request.explain) {
+                    results[valid[seat]] = encode_bot_result(calculate_pick_with_cards(request.drafter_state, request.options, cards, recognized));
+                } else {
+                    results[valid[seat]] = encode_bot_result(calculate_lean_pick_with_cards(request.drafter_state, request.options, cards));
+                }
+            },
+            num_threads);
+        return results;
+    }
+
+    // Like the above for an encoded batch of requests, returning the encoded batch of results or an empty vector if
+    // the batch itself could not be read, with reason set to why if given.
+    inline auto calculate_picks_encoded(std::span<const std::uint8_t> batch, std::size_t num_threads = 1,
+                                        const char** reason = nullptr) -> std::vector<std::uint8_t> {
+        std::vector<std::span<const std::uint8_t>> messages;
+        if (!decode_batch(batch, messages, reason)) return {};
+        return encode_batch(calculate_picks_encoded(std::span<const std::span<const std::uint8_t>>(messages), num_threads));
+    }
+}
+#endif
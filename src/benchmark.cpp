@@ -0,0 +1,425 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "mtgdraftbots/draft_session.hpp"
+#include "mtgdraftbots/mtgdraftbots.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+template <typename Func>
+double time_per_iteration_ns(std::size_t num_iterations, Func&& func) {
+    func();
+    const auto start = Clock::now();
+    for (std::size_t i = 0; i < num_iterations; i++) func();
+    const auto end = Clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / num_iterations;
+}
+
+std::string random_oracle_id(std::mt19937_64& rng) {
+    std::uniform_int_distribution<std::uint64_t> bits;
+    return mtgdraftbots::details::format_oracle_id({ bits(rng), bits(rng) });
+}
+
+void benchmark_card_lookups(std::mt19937_64& rng) {
+    constexpr std::size_t NUM_CARDS = 25'000;
+    constexpr std::size_t CUBE_SIZE = 540;
+    constexpr std::size_t NUM_ITERATIONS = 2'000;
+    std::vector<std::string> oracle_ids;
+    oracle_ids.reserve(NUM_CARDS);
+    std::map<std::string, mtgdraftbots::details::CardValue> card_map;
+    mtgdraftbots::details::CardTableBuilder builder;
+    builder.reserve(NUM_CARDS);
+    for (std::size_t i = 0; i < NUM_CARDS; i++) {
+        oracle_ids.push_back(random_oracle_id(rng));
+        card_map.insert({ oracle_ids.back(), mtgdraftbots::details::CardValue{ 0.5f, { 0.f }, {}, 32 } });
+        builder.insert(*mtgdraftbots::details::parse_oracle_id(oracle_ids.back()), 0.5f, { 0.f }, {}, 32);
+    }
+    const mtgdraftbots::details::CardTable card_table = std::move(builder).build();
+    std::vector<std::string> cube;
+    cube.reserve(CUBE_SIZE);
+    std::uniform_int_distribution<std::size_t> card_index(0, NUM_CARDS - 1);
+    for (std::size_t i = 0; i < CUBE_SIZE; i++) cube.push_back(oracle_ids[card_index(rng)]);
+
+    std::size_t found = 0;
+    const double map_find_ns = time_per_iteration_ns(NUM_ITERATIONS, [&]() {
+        for (const std::string& oracle_id : cube) found += card_map.find(oracle_id) != card_map.end();
+    });
+    const double table_find_ns = time_per_iteration_ns(NUM_ITERATIONS, [&]() {
+        for (const std::string& oracle_id : cube) found += card_table.find(oracle_id) != mtgdraftbots::details::CardTable::NOT_FOUND;
+    });
+    const double map_values_ns = time_per_iteration_ns(NUM_ITERATIONS, [&]() {
+        mtgdraftbots::details::CardValues values(cube, card_map);
+        found += values.size();
+    });
+    const double table_values_ns = time_per_iteration_ns(NUM_ITERATIONS, [&]() {
+        mtgdraftbots::details::CardValues values(cube, card_table);
+        found += values.size();
+    });
+    fmt::print("Card lookups ({} card cube, {} known cards, checksum {}):\n", CUBE_SIZE, NUM_CARDS, found);
+    fmt::print("\tstd::map find:          {:>10.1f} ns/cube {:>7.1f} ns/card\n", map_find_ns, map_find_ns / CUBE_SIZE);
+    fmt::print("\tCardTable find:         {:>10.1f} ns/cube {:>7.1f} ns/card\n", table_find_ns, table_find_ns / CUBE_SIZE);
+    fmt::print("\tCardValues from map:    {:>10.1f} ns/cube\n", map_values_ns);
+    fmt::print("\tCardValues from table:  {:>10.1f} ns/cube\n", table_values_ns);
+}
+
+template <typename T>
+void append_bytes(std::vector<char>& buffer, const T& value) {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+// Builds random params in the legacy format with the real oracle titles.
+std::vector<char> make_legacy_params(std::mt19937_64& rng, std::size_t num_cards) {
+    constexpr std::array<std::string_view, 6> TITLES{
+        "Rating", "Colors", "Openness", "Pick Synergy", "Internal Synergy", "External Synergy",
+    };
+    constexpr std::array<std::string_view, 8> SYMBOLS{ "{w}", "{u}", "{b}", "{r}", "{g}", "{2}", "w/u", "b/g" };
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+    std::vector<char> buffer;
+    for (std::size_t i = 0; i < mtgdraftbots::details::EMBEDDING_SIZE; i++) append_bytes(buffer, unit(rng) - 0.5f);
+    append_bytes(buffer, static_cast<std::uint8_t>(TITLES.size()));
+    for (std::string_view title : TITLES) {
+        for (std::size_t i = 0; i < mtgdraftbots::details::WEIGHT_X_DIM * mtgdraftbots::details::WEIGHT_Y_DIM; i++) {
+            append_bytes(buffer, unit(rng));
+        }
+        buffer.insert(buffer.end(), title.begin(), title.end());
+        buffer.push_back('\0');
+    }
+    append_bytes(buffer, static_cast<std::uint32_t>(num_cards));
+    for (std::size_t i = 0; i < num_cards; i++) {
+        append_bytes(buffer, unit(rng));
+        for (std::size_t j = 0; j < mtgdraftbots::details::EMBEDDING_SIZE; j++) append_bytes(buffer, unit(rng) - 0.5f);
+        append_bytes(buffer, static_cast<std::uint8_t>(i % 8 == 0 ? rng() % 32 : 32));
+        append_bytes(buffer, static_cast<std::uint8_t>(rng() % 8));
+        const std::uint8_t num_symbols = static_cast<std::uint8_t>(rng() % 4);
+        append_bytes(buffer, num_symbols);
+        for (std::size_t j = 0; j < num_symbols; j++) {
+            const std::string_view symbol = SYMBOLS[rng() % SYMBOLS.size()];
+            buffer.insert(buffer.end(), symbol.begin(), symbol.end());
+        }
+        const std::string oracle_id = random_oracle_id(rng);
+        buffer.insert(buffer.end(), oracle_id.begin(), oracle_id.end());
+    }
+    return buffer;
+}
+
+void benchmark_params_loading(std::mt19937_64& rng) {
+    constexpr std::size_t NUM_CARDS = 25'000;
+    constexpr std::size_t NUM_ITERATIONS = 20;
+    const std::vector<char> legacy_params = make_legacy_params(rng, NUM_CARDS);
+    const double legacy_ns = time_per_iteration_ns(NUM_ITERATIONS, [&]() {
+        mtgdraftbots::initialize_draftbots(legacy_params);
+    });
+    const auto versioned_params = std::make_shared<const std::vector<char>>(mtgdraftbots::details::serialize_params());
+    const double versioned_ns = time_per_iteration_ns(NUM_ITERATIONS, [&]() {
+        mtgdraftbots::initialize_draftbots(versioned_params);
+    });
+    fmt::print("Params loading ({} cards, {} legacy bytes, {} versioned bytes):\n", NUM_CARDS, legacy_params.size(),
+               versioned_params->size());
+    fmt::print("\tlegacy parse:           {:>10.3f} ms\n", legacy_ns / 1e6);
+    fmt::print("\tversioned in place:     {:>10.3f} ms\n", versioned_ns / 1e6);
+}
+
+// A 3 pack, 15 pick draft over a random cube drawn from the loaded params, with 5 land producing cards as basics.
+struct SimulatedDraft {
+    mtgdraftbots::DrafterState initial_state;
+    std::vector<std::vector<unsigned int>> packs;
+};
+
+SimulatedDraft make_simulated_draft(std::mt19937_64& rng) {
+    constexpr std::size_t CUBE_SIZE = 540;
+    constexpr unsigned int NUM_PACKS = 3;
+    constexpr unsigned int NUM_PICKS = 15;
+    const mtgdraftbots::details::CardTable& card_table = mtgdraftbots::details::card_table;
+    SimulatedDraft draft{};
+    std::uniform_int_distribution<std::size_t> card_index(0, card_table.size() - 1);
+    for (std::size_t i = 0; i < CUBE_SIZE; i++) {
+        draft.initial_state.card_oracle_ids.push_back(mtgdraftbots::details::format_oracle_id(card_table.oracle_ids[card_index(rng)]));
+    }
+    for (std::size_t i = 0; i < card_table.size() && draft.initial_state.basics.size() < 5; i++) {
+        if (card_table.produces[i] < 32) {
+            draft.initial_state.basics.push_back(static_cast<unsigned int>(draft.initial_state.card_oracle_ids.size()));
+            draft.initial_state.card_oracle_ids.push_back(mtgdraftbots::details::format_oracle_id(card_table.oracle_ids[i]));
+        }
+    }
+    draft.initial_state.num_packs = NUM_PACKS;
+    draft.initial_state.num_picks = NUM_PICKS;
+    draft.initial_state.seed = 37;
+    std::uniform_int_distribution<unsigned int> cube_index(0, CUBE_SIZE - 1);
+    for (unsigned int pick = 0; pick < NUM_PACKS * NUM_PICKS; pick++) {
+        std::vector<unsigned int> pack(NUM_PICKS - pick % NUM_PICKS);
+        for (unsigned int& card : pack) card = cube_index(rng);
+        draft.packs.push_back(std::move(pack));
+    }
+    return draft;
+}
+
+auto single_card_options(const std::vector<unsigned int>& pack) -> std::vector<mtgdraftbots::Option> {
+    std::vector<mtgdraftbots::Option> options;
+    for (unsigned int i = 0; i < pack.size(); i++) options.push_back({ i });
+    return options;
+}
+
+void benchmark_draft_session(const SimulatedDraft& draft) {
+    constexpr std::size_t NUM_ITERATIONS = 3;
+    // Repeating the same draft would otherwise only measure generate_probs_cache for the stateless picks.
+    const std::size_t cache_capacity = mtgdraftbots::details::generate_probs_cache.capacity();
+    mtgdraftbots::details::generate_probs_cache.set_capacity(0);
+    const unsigned int num_picks = draft.initial_state.num_picks;
+    std::size_t checksum = 0;
+    const double stateless_ns = time_per_iteration_ns(NUM_ITERATIONS, [&]() {
+        mtgdraftbots::DrafterState state = draft.initial_state;
+        for (unsigned int pick = 0; pick < draft.packs.size(); pick++) {
+            const std::vector<unsigned int>& pack = draft.packs[pick];
+            state.cards_in_pack = pack;
+            state.pack_num = pick / num_picks;
+            state.pick_num = pick % num_picks;
+            state.seen.insert(state.seen.end(), pack.begin(), pack.end());
+            const mtgdraftbots::BotResult result = mtgdraftbots::calculate_pick_from_options(state, single_card_options(pack));
+            state.picked.push_back(pack[result.chosen_option]);
+            checksum += result.chosen_option;
+        }
+    });
+    const double session_ns = time_per_iteration_ns(NUM_ITERATIONS, [&]() {
+        mtgdraftbots::DraftSession session(draft.initial_state);
+        for (unsigned int pick = 0; pick < draft.packs.size(); pick++) {
+            const std::vector<unsigned int>& pack = draft.packs[pick];
+            session.add_seen(pack);
+            const mtgdraftbots::BotResult result = session.calculate_pick(pack, single_card_options(pack), pick / num_picks,
+                                                                          pick % num_picks);
+            session.add_picked(pack[result.chosen_option]);
+            checksum += result.chosen_option;
+        }
+    });
+    const double lean_ns = time_per_iteration_ns(NUM_ITERATIONS, [&]() {
+        mtgdraftbots::DraftSession session(draft.initial_state);
+        for (unsigned int pick = 0; pick < draft.packs.size(); pick++) {
+            const std::vector<unsigned int>& pack = draft.packs[pick];
+            session.add_seen(pack);
+            const mtgdraftbots::LeanBotResult result = session.calculate_lean_pick(pack, single_card_options(pack),
+                                                                                   pick / num_picks, pick % num_picks);
+            session.add_picked(pack[result.chosen_option]);
+            checksum += result.chosen_option;
+        }
+    });
+    fmt::print("Full draft for one seat ({} picks, checksum {}):\n", draft.packs.size(), checksum);
+    fmt::print("\tcalculate_pick_from_options: {:>10.3f} ms\n", stateless_ns / 1e6);
+    fmt::print("\tDraftSession:                {:>10.3f} ms\n", session_ns / 1e6);
+    fmt::print("\tDraftSession lean:           {:>10.3f} ms\n", lean_ns / 1e6);
+    mtgdraftbots::details::generate_probs_cache.set_capacity(cache_capacity);
+}
+
+void benchmark_generate_probs_cache(const SimulatedDraft& draft) {
+    using namespace mtgdraftbots::details;
+    constexpr std::size_t NUM_ITERATIONS = 20;
+    const CardValues cards(draft.initial_state.card_oracle_ids);
+    mtgdraftbots::DrafterState state = draft.initial_state;
+    const std::size_t cache_capacity = generate_probs_cache.capacity();
+    double uncached_ns = 0;
+    double cached_ns = 0;
+    generate_probs_cache.clear();
+    for (unsigned int pick = 0; pick < draft.packs.size(); pick++) {
+        const std::vector<unsigned int>& pack = draft.packs[pick];
+        state.cards_in_pack = pack;
+        state.seen.insert(state.seen.end(), pack.begin(), pack.end());
+        generate_probs_cache.set_capacity(0);
+        uncached_ns += time_per_iteration_ns(1, [&]() { generate_probs(state, cards); });
+        generate_probs_cache.set_capacity(cache_capacity);
+        cached_ns += time_per_iteration_ns(NUM_ITERATIONS, [&]() { generate_probs(state, cards); });
+        state.picked.push_back(pack[pick % pack.size()]);
+    }
+    const double num_picks = static_cast<double>(draft.packs.size());
+    fmt::print("generate_probs cache ({} picks, {} hits, {} misses):\n", draft.packs.size(), generate_probs_cache.hits(),
+               generate_probs_cache.misses());
+    fmt::print("\tuncached: {:>8.3f} ms/pick\n", uncached_ns / num_picks / 1e6);
+    fmt::print("\tcached:   {:>8.3f} ms/pick\n", cached_ns / num_picks / 1e6);
+}
+
+void benchmark_generate_probs_warm_start(const SimulatedDraft& draft) {
+    using namespace mtgdraftbots::details;
+    const CardValues cards(draft.initial_state.card_oracle_ids);
+    mtgdraftbots::DrafterState state = draft.initial_state;
+    GenerateProbsStats cold_totals;
+    GenerateProbsStats warm_totals;
+    double cold_ns = 0;
+    double warm_ns = 0;
+    std::array<mtgdraftbots::Lands, NUM_LAND_COMBS> previous_lands;
+    for (unsigned int pick = 0; pick < draft.packs.size(); pick++) {
+        const std::vector<unsigned int>& pack = draft.packs[pick];
+        state.cards_in_pack = pack;
+        state.seen.insert(state.seen.end(), pack.begin(), pack.end());
+        const mtgdraftbots::Lands available_lands = get_available_lands(state, cards);
+        GenerateProbsStats cold_stats;
+        GenerateProbsStats warm_stats;
+        cold_ns += time_per_iteration_ns(1, [&]() { generate_probs(state, cards, available_lands, nullptr, &cold_stats); });
+        const std::array<mtgdraftbots::Lands, NUM_LAND_COMBS>* warm_start = pick > 0 ? &previous_lands : nullptr;
+        warm_ns += time_per_iteration_ns(1, [&]() {
+            previous_lands = generate_probs(state, cards, available_lands, warm_start, &warm_stats).second;
+        });
+        cold_totals.evaluations += cold_stats.evaluations;
+        warm_totals.evaluations += warm_stats.evaluations;
+        warm_totals.warm_started += warm_stats.warm_started;
+        warm_totals.random_restarts += warm_stats.random_restarts;
+        state.picked.push_back(pack[pick % pack.size()]);
+    }
+    const double num_picks = static_cast<double>(draft.packs.size());
+    fmt::print("generate_probs warm start ({} picks, {} warm started and {} restarted climbs):\n", draft.packs.size(),
+               warm_totals.warm_started, warm_totals.random_restarts);
+    fmt::print("\tcold:  {:>10.1f} evaluations/pick {:>8.3f} ms/pick\n", cold_totals.evaluations / num_picks, cold_ns / num_picks / 1e6);
+    fmt::print("\twarm:  {:>10.1f} evaluations/pick {:>8.3f} ms/pick\n", warm_totals.evaluations / num_picks, warm_ns / num_picks / 1e6);
+    fmt::print("\tsaved: {:>10.1f} evaluations/pick\n",
+               (static_cast<double>(cold_totals.evaluations) - static_cast<double>(warm_totals.evaluations)) / num_picks);
+}
+
+void benchmark_cost_evaluation(const SimulatedDraft& draft, std::mt19937_64& rng) {
+    using namespace mtgdraftbots::details;
+    constexpr std::size_t NUM_LANDS = 64;
+    constexpr std::size_t NUM_ITERATIONS = 200;
+    const CardValues cards(draft.initial_state.card_oracle_ids);
+    std::vector<mtgdraftbots::Lands> lands;
+    std::uniform_int_distribution<std::size_t> comb_index(1, 31);
+    for (std::size_t i = 0; i < NUM_LANDS; i++) {
+        mtgdraftbots::Lands& current = lands.emplace_back(mtgdraftbots::Lands{ 0 });
+        for (std::size_t j = 0; j < 17; j++) current[j < 12 ? j % 5 + 1 : comb_index(rng)]++;
+    }
+    std::vector<float> probs(cards.costs.size());
+    float checksum = 0;
+    const double variant_ns = time_per_iteration_ns(NUM_ITERATIONS, [&]() {
+        for (const mtgdraftbots::Lands& current : lands) {
+            std::transform(cards.costs.begin(), cards.costs.end(), probs.begin(),
+                           [&](const CardCost& cost) { return cost.calculate_probability(current); });
+            checksum += probs[0];
+        }
+    });
+    const double buckets_ns = time_per_iteration_ns(NUM_ITERATIONS, [&]() {
+        for (const mtgdraftbots::Lands& current : lands) {
+            cards.evaluate_costs(current, probs);
+            checksum += probs[0];
+        }
+    });
+    // The same as evaluate_costs but always through the scalar loops, without vectorclass this matches the above.
+    std::vector<std::uint32_t> usable(cards.cost_buckets.masks().size());
+    std::vector<float> unique_probs(cards.unique_costs.size());
+    const double scalar_buckets_ns = time_per_iteration_ns(NUM_ITERATIONS, [&]() {
+        for (const mtgdraftbots::Lands& current : lands) {
+            cards.cost_buckets.project(current, usable);
+            cards.cost_buckets.evaluate_projected_scalar(usable, unique_probs);
+            for (std::size_t i = 0; i < cards.cost_indices.size(); i++) probs[i] = unique_probs[cards.cost_indices[i]];
+            checksum += probs[0];
+        }
+    });
+    const double num_evaluated = static_cast<double>(cards.costs.size() * NUM_LANDS);
+    fmt::print("Cost evaluation ({} cards, {} unique costs, {} lands, checksum {}):\n", cards.costs.size(),
+               cards.unique_costs.size(), NUM_LANDS, checksum);
+    fmt::print("\tCardCost variant:       {:>10.1f} Mcards/s\n", num_evaluated / variant_ns * 1e3);
+    fmt::print("\tscalar CostBuckets:     {:>10.1f} Mcards/s\n", num_evaluated / scalar_buckets_ns * 1e3);
+    fmt::print("\tunique CostBuckets:     {:>10.1f} Mcards/s\n", num_evaluated / buckets_ns * 1e3);
+}
+
+// Generating the whole probability table on one thread, reading it back from a cache file, and random dependent
+// lookups over all of it so each one waits on the load before it.
+void benchmark_prob_table(std::mt19937_64& rng) {
+    using namespace mtgdraftbots::constants;
+    constexpr std::size_t NUM_LOOKUPS = 1 << 20;
+    constexpr std::size_t NUM_ITERATIONS = 10;
+    const auto generate_start = Clock::now();
+    mtgdraftbots::details::ProbTable table;
+    table.ensure_all();
+    const double generate_ms = std::chrono::duration<double, std::milli>(Clock::now() - generate_start).count();
+    const std::string cache_path = (std::filesystem::temp_directory_path() / "mtgdraftbots_benchmark_prob_table.bin").string();
+    double load_ms = -1;
+    if (table.save(cache_path)) {
+        const auto load_start = Clock::now();
+        mtgdraftbots::details::ProbTable loaded;
+        if (loaded.load(cache_path)) load_ms = std::chrono::duration<double, std::milli>(Clock::now() - load_start).count();
+        std::filesystem::remove(cache_path);
+    }
+
+    std::vector<std::uint32_t> indices;
+    indices.reserve(NUM_LOOKUPS);
+    std::uniform_int_distribution<std::size_t> slab_index(0, NUM_PROB_SLABS - 1);
+    std::uniform_int_distribution<std::uint32_t> usable_count(0, MAX_USABLE);
+    for (std::size_t i = 0; i < NUM_LOOKUPS; i++) {
+        indices.push_back(static_cast<std::uint32_t>(prob_index(slab_index(rng) * PROB_SLAB_SIZE, usable_count(rng),
+                                                                usable_count(rng), usable_count(rng))));
+    }
+    float checksum = 0;
+    const double lookup_ns = time_per_iteration_ns(NUM_ITERATIONS, [&]() {
+        std::size_t position = 0;
+        for (std::size_t i = 0; i < NUM_LOOKUPS; i++) {
+            const float prob = table[indices[position]];
+            checksum += prob;
+            position = (position + 1 + (prob < 0.f)) & (NUM_LOOKUPS - 1);
+        }
+    });
+    fmt::print("Probability table ({:.1f} MB, {} slabs, checksum {}):\n", PROB_TABLE_SIZE * sizeof(std::uint16_t) / 1e6,
+               NUM_PROB_SLABS, checksum);
+    fmt::print("\tgenerate:               {:>10.1f} ms {:>8.3f} ms/slab\n", generate_ms, generate_ms / NUM_PROB_SLABS);
+    fmt::print("\tload cache file:        {:>10.1f} ms\n", load_ms);
+    fmt::print("\trandom lookups:         {:>10.2f} ns/lookup\n", lookup_ns / NUM_LOOKUPS);
+}
+
+void benchmark_option_scoring(const SimulatedDraft& draft) {
+    using namespace mtgdraftbots::details;
+    constexpr std::size_t NUM_ITERATIONS = 200;
+    const CardValues cards(draft.initial_state.card_oracle_ids);
+    std::vector<BotState> bot_states;
+    mtgdraftbots::DrafterState state = draft.initial_state;
+    for (unsigned int pick = 0; pick < draft.packs.size(); pick += 5) {
+        const std::vector<unsigned int>& pack = draft.packs[pick];
+        state.cards_in_pack = pack;
+        state.pack_num = pick / state.num_picks;
+        state.pick_num = pick % state.num_picks;
+        state.seen.insert(state.seen.end(), pack.begin(), pack.end());
+        BotState& bot_state = bot_states.emplace_back(BotState{ state, single_card_options(pack), generate_probs(state, cards),
+                                                                get_weighted_coords(state), std::cref(cards) });
+        bot_state.calculate_embeddings();
+        state.picked.push_back(pack[0]);
+    }
+    std::size_t checksum = 0;
+    const double oracles_ns = time_per_iteration_ns(NUM_ITERATIONS, [&]() {
+        for (const BotState& bot_state : bot_states) {
+            mtgdraftbots::BotResult result;
+            score_options_with_oracles(bot_state, result);
+            checksum += result.chosen_option;
+        }
+    });
+    ScoreBuffers buffers;
+    const double kernel_ns = time_per_iteration_ns(NUM_ITERATIONS, [&]() {
+        for (const BotState& bot_state : bot_states) {
+            score_kernel(bot_state, buffers);
+            checksum += buffers.chosen_option;
+        }
+    });
+    const double num_states = static_cast<double>(bot_states.size());
+    fmt::print("Option scoring ({} picks, checksum {}):\n", bot_states.size(), checksum);
+    fmt::print("\tORACLES:                {:>10.1f} ns/pick\n", oracles_ns / num_states);
+    fmt::print("\tscore_kernel:           {:>10.1f} ns/pick\n", kernel_ns / num_states);
+}
+
+int main() {
+    std::mt19937_64 rng(0x5EED);
+    fmt::print("SIMD paths: {}\n", mtgdraftbots::details::instruction_set_name(mtgdraftbots::details::active_instruction_set()));
+    benchmark_card_lookups(rng);
+    benchmark_params_loading(rng);
+    const SimulatedDraft draft = make_simulated_draft(rng);
+    benchmark_draft_session(draft);
+    benchmark_generate_probs_warm_start(draft);
+    benchmark_generate_probs_cache(draft);
+    benchmark_prob_table(rng);
+    benchmark_cost_evaluation(draft, rng);
+    benchmark_option_scoring(draft);
+    return 0;
+}
@@ -0,0 +1,369 @@
+// Checks that the fast paths agree with the straightforward ones they replace on random params and a draft over a
+// random cube.
+// Exits with 1 and prints every disagreement if any check fails, so it can run as a test.
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "mtgdraftbots/mtgdraftbots.hpp"
+#include "mtgdraftbots/wire.hpp"
+
+namespace {
+    // Float results from the two paths may differ by rounding when the factors are multiplied in another order.
+    constexpr float TOLERANCE = 1e-6f;
+    // Scores are sums over many cards and oracles, so they are compared relative to their size.
+    constexpr float SCORE_TOLERANCE = 1e-5f;
+
+    struct Checker {
+        bool check(bool passed, std::string_view name, const std::string& detail) {
+            num_checks++;
+            if (!passed) {
+                num_failures++;
+                if (num_failures <= 20) fmt::print("FAILED {}: {}\n", name, detail);
+            }
+            return passed;
+        }
+
+        bool check_close(float expected, float actual, std::string_view name, const std::string& where,
+                         float tolerance = TOLERANCE) {
+            return check(std::abs(expected - actual) <= tolerance * std::max(1.f, std::abs(expected)), name,
+                         fmt::format("{} expected {} got {}", where, expected, actual));
+        }
+
+        std::size_t num_checks = 0;
+        std::size_t num_failures = 0;
+    };
+
+    std::string random_oracle_id(std::mt19937_64& rng) {
+        std::uniform_int_distribution<std::uint64_t> bits;
+        return mtgdraftbots::details::format_oracle_id({ bits(rng), bits(rng) });
+    }
+
+    template <typename T>
+    void append_bytes(std::vector<char>& buffer, const T& value) {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    // Random params in the legacy format with the real oracle titles and costs covering every requirement arity.
+    std::vector<char> make_legacy_params(std::mt19937_64& rng, std::size_t num_cards) {
+        constexpr std::array<std::string_view, 6> TITLES{
+            "Rating", "Colors", "Openness", "Pick Synergy", "Internal Synergy", "External Synergy",
+        };
+        constexpr std::array<std::string_view, 10> SYMBOLS{ "{w}", "{u}", "{b}", "{r}", "{g}", "{2}", "w/u", "b/g", "r/w", "{c}" };
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+        std::vector<char> buffer;
+        for (std::size_t i = 0; i < mtgdraftbots::details::EMBEDDING_SIZE; i++) append_bytes(buffer, unit(rng) - 0.5f);
+        append_bytes(buffer, static_cast<std::uint8_t>(TITLES.size()));
+        for (std::string_view title : TITLES) {
+            for (std::size_t i = 0; i < mtgdraftbots::details::WEIGHT_X_DIM * mtgdraftbots::details::WEIGHT_Y_DIM; i++) {
+                append_bytes(buffer, unit(rng));
+            }
+            buffer.insert(buffer.end(), title.begin(), title.end());
+            buffer.push_back('\0');
+        }
+        append_bytes(buffer, static_cast<std::uint32_t>(num_cards));
+        for (std::size_t i = 0; i < num_cards; i++) {
+            append_bytes(buffer, unit(rng));
+            for (std::size_t j = 0; j < mtgdraftbots::details::EMBEDDING_SIZE; j++) append_bytes(buffer, unit(rng) - 0.5f);
+            append_bytes(buffer, static_cast<std::uint8_t>(i % 8 == 0 ? rng() % 32 : 32));
+            append_bytes(buffer, static_cast<std::uint8_t>(rng() % 9));
+            const std::uint8_t num_symbols = static_cast<std::uint8_t>(rng() % 6);
+            append_bytes(buffer, num_symbols);
+            for (std::size_t j = 0; j < num_symbols; j++) {
+                const std::string_view symbol = SYMBOLS[rng() % SYMBOLS.size()];
+                buffer.insert(buffer.end(), symbol.begin(), symbol.end());
+            }
+            const std::string oracle_id = random_oracle_id(rng);
+            buffer.insert(buffer.end(), oracle_id.begin(), oracle_id.end());
+        }
+        return buffer;
+    }
+
+    auto random_cube(std::mt19937_64& rng, std::size_t cube_size) -> std::vector<std::string> {
+        const mtgdraftbots::details::CardTable& card_table = mtgdraftbots::details::card_table;
+        std::uniform_int_distribution<std::size_t> card_index(0, card_table.size() - 1);
+        std::vector<std::string> cube;
+        cube.reserve(cube_size);
+        for (std::size_t i = 0; i < cube_size; i++) {
+            cube.push_back(mtgdraftbots::details::format_oracle_id(card_table.oracle_ids[card_index(rng)]));
+        }
+        return cube;
+    }
+
+    // A 3 pack, 15 pick draft over cube with 5 land producing cards added as basics. Each pack holds indices into
+    // the card list.
+    struct GeneratedDraft {
+        mtgdraftbots::DrafterState initial_state;
+        std::vector<std::vector<unsigned int>> packs;
+    };
+
+    auto make_draft(std::mt19937_64& rng, std::vector<std::string> cube) -> GeneratedDraft {
+        constexpr unsigned int NUM_PACKS = 3;
+        constexpr unsigned int NUM_PICKS = 15;
+        const mtgdraftbots::details::CardTable& card_table = mtgdraftbots::details::card_table;
+        const auto cube_size = static_cast<unsigned int>(cube.size());
+        GeneratedDraft draft{};
+        draft.initial_state.card_oracle_ids = std::move(cube);
+        for (std::size_t i = 0; i < card_table.size() && draft.initial_state.basics.size() < 5; i++) {
+            if (card_table.produces[i] < 32) {
+                draft.initial_state.basics.push_back(static_cast<unsigned int>(draft.initial_state.card_oracle_ids.size()));
+                draft.initial_state.card_oracle_ids.push_back(mtgdraftbots::details::format_oracle_id(card_table.oracle_ids[i]));
+            }
+        }
+        draft.initial_state.num_packs = NUM_PACKS;
+        draft.initial_state.num_picks = NUM_PICKS;
+        draft.initial_state.seed = 37;
+        std::uniform_int_distribution<unsigned int> cube_index(0, cube_size - 1);
+        for (unsigned int pick = 0; pick < NUM_PACKS * NUM_PICKS; pick++) {
+            std::vector<unsigned int> pack(NUM_PICKS - pick % NUM_PICKS);
+            for (unsigned int& card : pack) card = cube_index(rng);
+            draft.packs.push_back(std::move(pack));
+        }
+        return draft;
+    }
+
+    // The state of the drafter at each pick when they always take the first card of the pack.
+    auto draft_states(const GeneratedDraft& draft) -> std::vector<mtgdraftbots::DrafterState> {
+        std::vector<mtgdraftbots::DrafterState> states;
+        mtgdraftbots::DrafterState state = draft.initial_state;
+        for (unsigned int pick = 0; pick < draft.packs.size(); pick++) {
+            const std::vector<unsigned int>& pack = draft.packs[pick];
+            state.cards_in_pack = pack;
+            state.pack_num = pick / state.num_picks;
+            state.pick_num = pick % state.num_picks;
+            state.seen.insert(state.seen.end(), pack.begin(), pack.end());
+            states.push_back(state);
+            state.picked.push_back(pack[0]);
+        }
+        return states;
+    }
+
+    // 17 lands, mostly basics with some duals and more, like the decks generate_probs searches over.
+    auto random_lands(std::mt19937_64& rng) -> mtgdraftbots::Lands {
+        std::uniform_int_distribution<std::size_t> comb_index(1, mtgdraftbots::constants::COLOR_COMBINATIONS.size() - 1);
+        std::uniform_int_distribution<std::size_t> num_basics(0, 17);
+        mtgdraftbots::Lands lands{ 0 };
+        const std::size_t basics = num_basics(rng);
+        for (std::size_t i = 0; i < 17; i++) lands[i < basics ? rng() % 5 + 1 : comb_index(rng)]++;
+        return lands;
+    }
+
+    // The vectorclass evaluation, where it is compiled in, against the scalar loops, and both against visiting each
+    // CardCost.
+    void check_cost_evaluation(Checker& checker, const mtgdraftbots::details::CardValues& cards, std::mt19937_64& rng) {
+        using namespace mtgdraftbots::details;
+        constexpr std::size_t NUM_LANDS = 256;
+        const CostBuckets& buckets = cards.cost_buckets;
+        std::vector<std::uint32_t> usable(buckets.masks().size());
+        std::vector<float> probs(buckets.size());
+        std::vector<float> scalar_probs(buckets.size());
+        for (std::size_t i = 0; i < NUM_LANDS; i++) {
+            const mtgdraftbots::Lands lands = random_lands(rng);
+            buckets.project(lands, usable);
+            buckets.evaluate_projected(usable, probs);
+            buckets.evaluate_projected_scalar(usable, scalar_probs);
+            for (std::size_t cost = 0; cost < cards.unique_costs.size(); cost++) {
+                const std::string where = fmt::format("lands {} cost {}", i, cost);
+                checker.check_close(scalar_probs[cost], probs[cost], "evaluate_projected", where);
+                checker.check_close(cards.unique_costs[cost].calculate_probability(lands), scalar_probs[cost],
+                                    "evaluate_projected_scalar", where);
+            }
+        }
+    }
+
+    // Every move DeltaEvaluator::evaluate scores as a delta from a base against fully evaluating the moved lands.
+    void check_delta_evaluator(Checker& checker, const mtgdraftbots::details::CardValues& cards,
+                               const std::vector<mtgdraftbots::DrafterState>& states, std::mt19937_64& rng) {
+        using namespace mtgdraftbots::details;
+        constexpr std::size_t NUM_BASES = 8;
+        for (std::size_t pick = 0; pick < states.size(); pick += 4) {
+            DeltaEvaluator delta(states[pick], cards);
+            DeltaEvaluator full(states[pick], cards);
+            for (std::size_t base = 0; base < NUM_BASES; base++) {
+                const mtgdraftbots::Lands base_lands = random_lands(rng);
+                delta.set_base(base_lands);
+                for (std::uint8_t increase = 1; increase < 32; increase++) {
+                    for (std::uint8_t decrease = 0; decrease < 32; decrease++) {
+                        if (decrease == increase || base_lands[decrease] == 0) continue;
+                        mtgdraftbots::Lands new_lands = base_lands;
+                        const auto amount = static_cast<std::uint8_t>(rng() % base_lands[decrease] + 1);
+                        new_lands[increase] += amount;
+                        new_lands[decrease] -= amount;
+                        checker.check_close(full.set_base(new_lands), delta.evaluate(new_lands, increase, decrease),
+                                            "DeltaEvaluator::evaluate",
+                                            fmt::format("pick {} base {} move {} from {} to {}", pick, base, amount,
+                                                        decrease, increase),
+                                            SCORE_TOLERANCE);
+                    }
+                }
+            }
+        }
+    }
+
+    // score_kernel against running the oracles, with every card of the pack as an option and some pairs of them.
+    // Options hold positions in the pack.
+    void check_score_kernel(Checker& checker, const mtgdraftbots::details::CardValues& cards,
+                            const std::vector<mtgdraftbots::DrafterState>& states) {
+        using namespace mtgdraftbots::details;
+        ScoreBuffers buffers;
+        for (std::size_t pick = 0; pick < states.size(); pick++) {
+            const mtgdraftbots::DrafterState& state = states[pick];
+            std::vector<mtgdraftbots::Option> options;
+            for (unsigned int i = 0; i < state.cards_in_pack.size(); i++) options.push_back({ i });
+            for (unsigned int i = 1; i < state.cards_in_pack.size(); i += 3) options.push_back({ i - 1, i });
+            BotState bot_state{ state, options, generate_probs(state, cards), get_weighted_coords(state), std::cref(cards) };
+            bot_state.calculate_embeddings();
+            mtgdraftbots::BotResult result{ state, options, {}, {}, 0 };
+            score_options_with_oracles(bot_state, result);
+            score_kernel(bot_state, buffers);
+            if (!checker.check(buffers.num_options == result.scores.size(), "score_kernel",
+                               fmt::format("pick {} scored {} of {} options", pick, buffers.num_options, result.scores.size()))) {
+                continue;
+            }
+            for (std::size_t i = 0; i < result.scores.size(); i++) {
+                checker.check_close(result.scores[i].score, buffers.best_scores[i], "score_kernel",
+                                    fmt::format("pick {} option {}", pick, i), SCORE_TOLERANCE);
+            }
+            // Options within rounding of each other may be chosen either way.
+            const float chosen_score = result.scores[result.chosen_option].score;
+            checker.check(buffers.chosen_option == result.chosen_option
+                              || std::abs(result.scores[buffers.chosen_option].score - chosen_score)
+                                     <= SCORE_TOLERANCE * std::max(1.f, std::abs(chosen_score)),
+                          "score_kernel",
+                          fmt::format("pick {} chose option {} instead of {}", pick, buffers.chosen_option, result.chosen_option));
+        }
+    }
+
+    auto same_request(const mtgdraftbots::PickRequest& expected, const mtgdraftbots::PickRequest& actual) -> bool {
+        const mtgdraftbots::DrafterState& left = expected.drafter_state;
+        const mtgdraftbots::DrafterState& right = actual.drafter_state;
+        return left.picked == right.picked && left.seen == right.seen && left.cards_in_pack == right.cards_in_pack
+            && left.basics == right.basics && left.card_oracle_ids == right.card_oracle_ids
+            && left.pack_num == right.pack_num && left.num_packs == right.num_packs && left.pick_num == right.pick_num
+            && left.num_picks == right.num_picks && left.seed == right.seed && expected.options == actual.options
+            && expected.explain == actual.explain;
+    }
+
+    // decode must reject bytes with a reason, never read past them or accept them.
+    template <typename Decode>
+    void check_rejected(Checker& checker, std::string_view name, const std::string& where, Decode&& decode) {
+        const char* reason = nullptr;
+        const bool decoded = decode(reason);
+        checker.check(!decoded && reason != nullptr, name, fmt::format("{} was {}", where, decoded ? "accepted" : "rejected without a reason"));
+    }
+
+    // Requests and batches survive encoding and decoding, and truncated messages, counts larger than the message and
+    // offsets out of range or out of order are rejected.
+    void check_wire(Checker& checker, const std::vector<mtgdraftbots::DrafterState>& states) {
+        using namespace mtgdraftbots;
+        // Header fields in order, the counts start at num_picked.
+        constexpr std::size_t HEADER_SIZE = 15 * sizeof(std::uint32_t);
+        constexpr std::size_t FIRST_COUNT = 8;
+        const auto set_u32 = [](std::vector<std::uint8_t>& bytes, std::size_t position, std::uint32_t value) {
+            std::memcpy(bytes.data() + position, &value, sizeof(value));
+        };
+        std::vector<std::vector<std::uint8_t>> messages;
+        std::vector<PickRequest> requests;
+        for (std::size_t pick = 0; pick < states.size(); pick += 5) {
+            PickRequest request{ states[pick], {}, pick % 2 == 0 };
+            for (unsigned int i = 0; i < request.drafter_state.cards_in_pack.size(); i++) request.options.push_back({ i });
+            if (request.options.size() > 1) request.options.push_back({ 0, 1 });
+            const std::vector<std::uint8_t> bytes = encode_pick_request(request);
+            PickRequest decoded;
+            const char* reason = nullptr;
+            checker.check(decode_pick_request(bytes, decoded, &reason) && same_request(request, decoded), "wire round trip",
+                          fmt::format("pick {} {}", pick, reason != nullptr ? reason : "decoded differently"));
+            const std::string where = fmt::format("pick {}", pick);
+            for (std::size_t size = 0; size < bytes.size(); size += size < HEADER_SIZE + 64 ? 1 : 61) {
+                check_rejected(checker, "wire truncated request", fmt::format("{} cut to {} bytes", where, size),
+                               [&](const char*& why) { return decode_pick_request(std::span(bytes).first(size), decoded, &why); });
+            }
+            for (std::size_t field = FIRST_COUNT; field < 15; field++) {
+                for (const std::uint32_t count : { std::uint32_t{ 0xFFFFFFFF }, static_cast<std::uint32_t>(bytes.size()) }) {
+                    std::vector<std::uint8_t> oversized = bytes;
+                    set_u32(oversized, field * sizeof(std::uint32_t), count);
+                    check_rejected(checker, "wire oversized count", fmt::format("{} field {} set to {}", where, field, count),
+                                   [&](const char*& why) { return decode_pick_request(oversized, decoded, &why); });
+                }
+            }
+            const DrafterState& state = request.drafter_state;
+            const std::size_t option_offsets = HEADER_SIZE
+                + sizeof(std::uint32_t) * (state.picked.size() + state.seen.size() + state.cards_in_pack.size() + state.basics.size());
+            std::size_t num_option_cards = 0;
+            for (const Option& option : request.options) num_option_cards += option.size();
+            const std::size_t oracle_id_offsets = option_offsets + sizeof(std::uint32_t) * (request.options.size() + 1 + num_option_cards);
+            const std::size_t num_cards = state.card_oracle_ids.size();
+            const std::array<std::pair<std::size_t, std::uint32_t>, 5> bad_offsets{ {
+                { option_offsets, 1 },
+                { option_offsets + sizeof(std::uint32_t), static_cast<std::uint32_t>(num_option_cards + 1) },
+                { oracle_id_offsets, 1 },
+                { oracle_id_offsets + sizeof(std::uint32_t) * num_cards, static_cast<std::uint32_t>(bytes.size()) },
+                { HEADER_SIZE, static_cast<std::uint32_t>(num_cards) },
+            } };
+            for (const auto& [position, value] : bad_offsets) {
+                if (position == HEADER_SIZE && state.picked.empty()) continue;
+                std::vector<std::uint8_t> corrupted = bytes;
+                set_u32(corrupted, position, value);
+                check_rejected(checker, "wire bad offset", fmt::format("{} byte {} set to {}", where, position, value),
+                               [&](const char*& why) { return decode_pick_request(corrupted, decoded, &why); });
+            }
+            messages.push_back(bytes);
+            requests.push_back(std::move(request));
+        }
+        const std::vector<std::uint8_t> batch = encode_batch(messages);
+        std::vector<std::span<const std::uint8_t>> decoded_messages;
+        bool round_trip = decode_batch(batch, decoded_messages) && decoded_messages.size() == messages.size();
+        for (std::size_t i = 0; round_trip && i < messages.size(); i++) {
+            // Messages are padded to 4 bytes in the batch.
+            round_trip = decoded_messages[i].size() >= messages[i].size()
+                && std::equal(messages[i].begin(), messages[i].end(), decoded_messages[i].begin());
+        }
+        checker.check(round_trip, "wire batch round trip", fmt::format("{} messages", messages.size()));
+        for (std::size_t size = 0; size < 4 * (messages.size() + 4); size++) {
+            check_rejected(checker, "wire truncated batch", fmt::format("cut to {} bytes", size),
+                           [&](const char*& why) { return decode_batch(std::span(batch).first(size), decoded_messages, &why); });
+        }
+        std::vector<std::uint8_t> corrupted = batch;
+        set_u32(corrupted, 2 * sizeof(std::uint32_t), 0xFFFFFFFF);
+        check_rejected(checker, "wire oversized count", "batch count",
+                       [&](const char*& why) { return decode_batch(corrupted, decoded_messages, &why); });
+        for (const std::uint32_t offset : { std::uint32_t{ 0 }, static_cast<std::uint32_t>(batch.size() + 4) }) {
+            corrupted = batch;
+            set_u32(corrupted, 4 * sizeof(std::uint32_t), offset);
+            check_rejected(checker, "wire bad offset", fmt::format("batch offset set to {}", offset),
+                           [&](const char*& why) { return decode_batch(corrupted, decoded_messages, &why); });
+        }
+    }
+}
+
+int main() {
+    constexpr std::size_t NUM_CARDS = 5'000;
+    constexpr std::size_t CUBE_SIZE = 540;
+    std::mt19937_64 rng(0xC4EC);
+    if (!mtgdraftbots::initialize_draftbots(make_legacy_params(rng, NUM_CARDS))) {
+        fmt::print("FAILED loading the generated params\n");
+        return 1;
+    }
+    fmt::print("SIMD paths: {}\n", mtgdraftbots::details::instruction_set_name(mtgdraftbots::details::active_instruction_set()));
+    Checker checker;
+    const GeneratedDraft draft = make_draft(rng, random_cube(rng, CUBE_SIZE));
+    const std::vector<mtgdraftbots::DrafterState> states = draft_states(draft);
+    const mtgdraftbots::details::CardValues cards(draft.initial_state.card_oracle_ids);
+    check_cost_evaluation(checker, cards, rng);
+    check_delta_evaluator(checker, cards, states, rng);
+    check_score_kernel(checker, cards, states);
+    check_wire(checker, states);
+    fmt::print("{} of {} checks failed\n", checker.num_failures, checker.num_checks);
+    return checker.num_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,279 @@
+// Writes the trained table that used to be compiled in from include/mtgdraftbots/generated/prob_table.hpp as the
+// probability table file the library loads by default (MTGDRAFTBOTS_PROB_TABLE_PATH), and compares it with the table
+// cast_probability generates where that file is missing. It is only built when that header exists.
+//
+// It reports the largest difference over the entries cost evaluation can reach, for cast_probability and for a few
+// other deck sizes and draw counts. Given params and a cube list in the format SimulateDrafts reads, it also reports
+// how often the picks and the lands of the picked cards agree between the two tables. Those are replayed from bot
+// only drafts over the cube, so both tables decide on the same states.
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "mtgdraftbots/draft_simulator.hpp"
+#include "mtgdraftbots/mtgdraftbots.hpp"
+
+#include "parse_count.hpp"
+
+namespace legacy {
+    // The trained table kept 32 values for each usable count, with usable a innermost and usable ab outermost.
+    constexpr std::size_t COUNT_DIMS_EXP = 5;
+    constexpr std::size_t PROB_TABLE_SIZE = mtgdraftbots::constants::NUM_PROB_SLABS << (3 * COUNT_DIMS_EXP);
+
+#include "mtgdraftbots/generated/prob_table.hpp"
+
+    constexpr auto prob_index(std::size_t cmc, std::size_t required_a, std::size_t required_b, std::size_t usable_a,
+                              std::size_t usable_b, std::size_t usable_ab) noexcept -> std::size_t {
+        using namespace mtgdraftbots::constants;
+        return (((cmc * NUM_REQUIRED_A + required_a) * NUM_REQUIRED_B + required_b) << (3 * COUNT_DIMS_EXP))
+             | (usable_ab << (2 * COUNT_DIMS_EXP)) | (usable_b << COUNT_DIMS_EXP) | usable_a;
+    }
+}
+
+namespace {
+    using mtgdraftbots::constants::MAX_USABLE;
+    using mtgdraftbots::constants::NUM_CMC;
+    using mtgdraftbots::constants::NUM_REQUIRED_A;
+    using mtgdraftbots::constants::NUM_REQUIRED_B;
+    using mtgdraftbots::constants::NUM_USABLE;
+
+    // Calls f(cmc, required_a, required_b, usable_a, usable_b, usable_ab) for every entry a CardCost can look up. A
+    // single requirement leaves usable b and ab at 0. Two requirements have required a >= required b > 0, and the
+    // lands that pay for either include the ones that only pay for a or b.
+    template <typename F>
+    void for_each_reachable(F&& f) {
+        for (std::size_t cmc = 0; cmc < NUM_CMC; cmc++) {
+            for (std::size_t required_a = 1; required_a < NUM_REQUIRED_A; required_a++) {
+                for (std::size_t usable_a = 0; usable_a <= MAX_USABLE; usable_a++) f(cmc, required_a, 0, usable_a, 0, 0);
+                for (std::size_t required_b = 1; required_b <= std::min(required_a, NUM_REQUIRED_B - 1); required_b++) {
+                    for (std::size_t usable_ab = 0; usable_ab <= MAX_USABLE; usable_ab++) {
+                        for (std::size_t usable_b = 0; usable_b <= usable_ab; usable_b++) {
+                            for (std::size_t usable_a = 0; usable_a + usable_b <= usable_ab; usable_a++) {
+                                f(cmc, required_a, required_b, usable_a, usable_b, usable_ab);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Prints the largest difference of model from the trained table, where it is and how many entries differ by
+    // more than the 16 bit quantization of the table.
+    template <typename Model>
+    void report_difference(const std::string& name, Model&& model) {
+        double max_difference = 0;
+        std::array<std::size_t, 6> max_at{ 0 };
+        std::size_t num_entries = 0;
+        std::size_t num_above_quantization = 0;
+        for_each_reachable([&](std::size_t cmc, std::size_t required_a, std::size_t required_b, std::size_t usable_a,
+                               std::size_t usable_b, std::size_t usable_ab) {
+            const double trained = legacy::PROB_TABLE[legacy::prob_index(cmc, required_a, required_b, usable_a, usable_b,
+                                                                         usable_ab)];
+            const double difference = std::abs(model(cmc, required_a, required_b, usable_a, usable_b, usable_ab) - trained);
+            num_entries++;
+            if (difference > 1. / mtgdraftbots::constants::PROB_SCALE) num_above_quantization++;
+            if (difference > max_difference) {
+                max_difference = difference;
+                max_at = { cmc, required_a, required_b, usable_a, usable_b, usable_ab };
+            }
+        });
+        fmt::print("{:<32} max difference {:.6f} at cmc {} required {}/{} usable {}/{}/{}, {} of {} entries differ by "
+                   "more than 1/{}.\n", name, max_difference, max_at[0], max_at[1], max_at[2], max_at[3], max_at[4],
+                   max_at[5], num_above_quantization, num_entries, mtgdraftbots::constants::PROB_SCALE);
+    }
+
+    // probability(cmc, required_a, required_b, usable_a, usable_b, usable_ab) for every entry of details::ProbTable.
+    template <typename Probability>
+    std::vector<std::uint16_t> make_table(Probability&& probability) {
+        std::vector<std::uint16_t> result(mtgdraftbots::constants::PROB_TABLE_SIZE);
+        for (std::size_t cmc = 0; cmc < NUM_CMC; cmc++) {
+            for (std::size_t required_a = 0; required_a < NUM_REQUIRED_A; required_a++) {
+                for (std::size_t required_b = 0; required_b < NUM_REQUIRED_B; required_b++) {
+                    const std::size_t slab_offset = mtgdraftbots::constants::prob_slab_offset(cmc, required_a, required_b);
+                    for (std::uint32_t usable_ab = 0; usable_ab < NUM_USABLE; usable_ab++) {
+                        for (std::uint32_t usable_b = 0; usable_b < NUM_USABLE; usable_b++) {
+                            for (std::uint32_t usable_a = 0; usable_a < NUM_USABLE; usable_a++) {
+                                result[mtgdraftbots::constants::prob_index(slab_offset, usable_a, usable_b, usable_ab)]
+                                    = mtgdraftbots::details::ProbTable::encode(
+                                        probability(cmc, required_a, required_b, usable_a, usable_b, usable_ab));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    bool read_cube_list(const std::string& path, std::vector<std::string>& cube, std::vector<std::string>& basics) {
+        std::ifstream input(path);
+        if (!input) {
+            std::cerr << "Could not open the cube list " << path << '.' << std::endl;
+            return false;
+        }
+        std::vector<std::string>* section = &cube;
+        std::string line;
+        while (std::getline(input, line)) {
+            const auto is_space = [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
+            line.erase(std::find_if_not(std::rbegin(line), std::rend(line), is_space).base(), std::end(line));
+            if (line.empty() || line.front() == '#') continue;
+            if (line == "[basics]") section = &basics;
+            else section->push_back(line);
+        }
+        return true;
+    }
+
+    struct Decision {
+        unsigned int chosen_option;
+        mtgdraftbots::Lands lands;
+    };
+
+    // The full pick of every seat at every pick of the logged drafts. The states are rebuilt from the logs rather than
+    // from the picks made here, so a different pick does not change the states the later ones are made on.
+    std::vector<Decision> replay(const std::vector<mtgdraftbots::DraftLog>& logs, const mtgdraftbots::DrafterState& initial_state,
+                                 const mtgdraftbots::PodConfig& config, const mtgdraftbots::details::CardValues& cards,
+                                 const std::vector<int>& recognized) {
+        std::vector<Decision> decisions;
+        std::vector<mtgdraftbots::Option> options;
+        for (const mtgdraftbots::DraftLog& log : logs) {
+            std::vector<mtgdraftbots::DrafterState> states(config.num_seats, initial_state);
+            for (unsigned int seat = 0; seat < config.num_seats; seat++) {
+                states[seat].seed = static_cast<unsigned int>(log.seed * config.num_seats + seat);
+            }
+            for (unsigned int pack_num = 0; pack_num < config.num_packs; pack_num++) {
+                std::vector<std::vector<unsigned int>> in_hand = log.packs[pack_num];
+                for (unsigned int pick_num = 0; pick_num < config.pack_size; pick_num++) {
+                    for (unsigned int seat = 0; seat < config.num_seats; seat++) {
+                        std::vector<unsigned int>& pack = in_hand[seat];
+                        mtgdraftbots::DrafterState& state = states[seat];
+                        state.cards_in_pack = pack;
+                        state.seen.insert(std::end(state.seen), std::begin(pack), std::end(pack));
+                        state.pack_num = pack_num;
+                        state.pick_num = pick_num;
+                        options.resize(pack.size());
+                        for (unsigned int i = 0; i < pack.size(); i++) options[i] = { i };
+                        const mtgdraftbots::BotResult result
+                            = mtgdraftbots::calculate_pick_with_cards(state, options, cards, recognized);
+                        decisions.push_back({ result.chosen_option, result.scores[result.chosen_option].lands });
+                        const unsigned int picked = log.picks[seat][pack_num * config.pack_size + pick_num];
+                        state.picked.push_back(picked);
+                        pack.erase(std::find(std::begin(pack), std::end(pack), picked));
+                    }
+                    if (pack_num % 2 == 0) {
+                        std::rotate(std::rbegin(in_hand), std::rbegin(in_hand) + 1, std::rend(in_hand));
+                    } else {
+                        std::rotate(std::begin(in_hand), std::begin(in_hand) + 1, std::end(in_hand));
+                    }
+                }
+            }
+        }
+        return decisions;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2 && (argc < 4 || argc > 6)) {
+        std::cerr << "Usage: " << argv[0] << " <prob table file> [<params> <cube list> [num drafts] [first seed]]"
+                  << std::endl;
+        return 1;
+    }
+
+    report_difference("cast_probability", mtgdraftbots::details::cast_probability);
+    for (std::size_t deck_size : { 40, 41, 42, 45 }) {
+        for (std::size_t extra_draw : { 0, 1 }) {
+            report_difference(fmt::format("{} cards on the {}", deck_size, extra_draw == 0 ? "play" : "draw"),
+                              [&](std::size_t cmc, std::size_t required_a, std::size_t required_b, std::size_t usable_a,
+                                  std::size_t usable_b, std::size_t usable_ab) {
+                using namespace mtgdraftbots::constants;
+                return mtgdraftbots::details::draw_probability(
+                    deck_size, OPENING_HAND_SIZE + std::max<std::size_t>(cmc, 1) - 1 + extra_draw, required_a, required_b,
+                    usable_a, usable_b, usable_ab);
+            });
+        }
+    }
+
+    const std::vector<std::uint16_t> trained = make_table([](std::size_t cmc, std::size_t required_a,
+                                                             std::size_t required_b, std::size_t usable_a,
+                                                             std::size_t usable_b, std::size_t usable_ab) -> double {
+        return legacy::PROB_TABLE[legacy::prob_index(cmc, required_a, required_b, usable_a, usable_b, usable_ab)];
+    });
+    const std::filesystem::path table_path(argv[1]);
+    if (table_path.has_parent_path()) std::filesystem::create_directories(table_path.parent_path());
+    if (!mtgdraftbots::details::ProbTable::write(argv[1], trained.data())) {
+        std::cerr << "Could not write the probability table " << argv[1] << '.' << std::endl;
+        return 1;
+    }
+    fmt::print("Wrote the trained table to {}.\n", argv[1]);
+    if (argc == 2) return 0;
+    std::size_t num_drafts = 10;
+    std::uint64_t first_seed = 0;
+    if ((argc > 4 && !parse_count(argv[4], "number of drafts", num_drafts))
+        || (argc > 5 && !parse_count(argv[5], "first seed", first_seed, true))) {
+        return 1;
+    }
+
+    // Filled before the params are loaded so neither the trained file nor lazy generation touch the table.
+    const std::vector<std::uint16_t> generated = make_table(mtgdraftbots::details::cast_probability);
+    mtgdraftbots::details::prob_table.assign(generated.data());
+    if (!mtgdraftbots::initialize_draftbots_from_file(argv[2])) return 1;
+    std::vector<std::string> cube;
+    std::vector<std::string> basics;
+    if (!read_cube_list(argv[3], cube, basics)) return 1;
+    const mtgdraftbots::PodConfig config;
+    mtgdraftbots::DrafterState initial_state{};
+    initial_state.card_oracle_ids = cube;
+    initial_state.card_oracle_ids.insert(std::end(initial_state.card_oracle_ids), std::begin(basics), std::end(basics));
+    for (std::size_t i = cube.size(); i < initial_state.card_oracle_ids.size(); i++) {
+        initial_state.basics.push_back(static_cast<unsigned int>(i));
+    }
+    initial_state.num_packs = config.num_packs;
+    initial_state.num_picks = config.pack_size;
+    const mtgdraftbots::DraftSimulator simulator(std::move(cube), basics, config);
+    if (!simulator.valid()) {
+        std::cerr << "The cube cannot fill " << config.num_packs << " packs of " << config.pack_size << " for "
+                  << config.num_seats << " seats." << std::endl;
+        return 1;
+    }
+    std::vector<mtgdraftbots::DraftLog> logs(num_drafts);
+    std::mutex logs_mutex;
+    simulator.simulate_many(first_seed, num_drafts, std::max(1u, std::thread::hardware_concurrency()),
+                            [&](const mtgdraftbots::DraftLog& log) {
+        const std::lock_guard lock(logs_mutex);
+        logs[log.seed - first_seed] = log;
+    });
+
+    const mtgdraftbots::details::CardValues cards(initial_state.card_oracle_ids);
+    const std::vector<int> recognized = mtgdraftbots::test_recognized(initial_state.card_oracle_ids);
+    const std::vector<Decision> from_generated = replay(logs, initial_state, config, cards, recognized);
+    // The cached land combinations were found with the generated table.
+    mtgdraftbots::details::prob_table.assign(trained.data());
+    mtgdraftbots::details::generate_probs_cache.clear();
+    const std::vector<Decision> from_trained = replay(logs, initial_state, config, cards, recognized);
+
+    std::size_t same_picks = 0;
+    std::size_t same_lands = 0;
+    for (std::size_t i = 0; i < from_generated.size(); i++) {
+        if (from_generated[i].chosen_option == from_trained[i].chosen_option) same_picks++;
+        if (from_generated[i].lands == from_trained[i].lands) same_lands++;
+    }
+    const double num_picks = static_cast<double>(from_generated.size());
+    fmt::print("Over {} picks of {} drafts: {:.2f}% of the picks and {:.2f}% of the picked cards' lands agree.\n",
+               from_generated.size(), num_drafts, 100 * same_picks / num_picks, 100 * same_lands / num_picks);
+    return 0;
+}
@@ -0,0 +1,23 @@
+#include <fstream>
+#include <iostream>
+
+#include <fmt/core.h>
+
+#include "mtgdraftbots/mtgdraftbots.hpp"
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <input params> <output params>" << std::endl;
+        return 1;
+    }
+    if (!mtgdraftbots::initialize_draftbots_from_file(argv[1])) return 1;
+    std::vector<char> serialized = mtgdraftbots::details::serialize_params();
+    std::ofstream output(argv[2], std::ios::binary);
+    output.write(serialized.data(), static_cast<std::streamsize>(serialized.size()));
+    if (!output) {
+        std::cerr << "Could not write the params file " << argv[2] << '.' << std::endl;
+        return 1;
+    }
+    fmt::print("Wrote {} cards ({} bytes) to {}.\n", mtgdraftbots::details::card_table.size(), serialized.size(), argv[2]);
+    return 0;
+}
@@ -1,3 +1,4 @@
+#include <iostream>
 #include <string>
 #include <vector>
 
@@ -5,6 +6,7 @@
 #include <emscripten/bind.h>
 
 #include "mtgdraftbots/mtgdraftbots.hpp"
+#include "mtgdraftbots/wire.hpp"
 
 using namespace emscripten;
 using namespace mtgdraftbots;
@@ -42,25 +44,73 @@ namespace emscripten {
 void pass_data_to_initialize(void*, void* data, int len) {
 	std::vector<char> file_buffer(len, '\0');
 	std::memcpy(file_buffer.data(), data, file_buffer.size());
-	initialize_draftbots(file_buffer);
+	initialize_draftbots(std::move(file_buffer));
 };
 
 void initialize_error(void*) {
 	std::cerr << "Error initializing" << std::endl;
 }
 
-std::vector<std::string> initialize_with_data(std::string data, int len) {
+// data can be an ArrayBuffer or any typed array/Buffer. It is copied straight into the wasm heap exactly once,
+// versioned params are then used in place from that copy.
+std::vector<std::string> initialize_with_data(val data, int len) {
+	const val uint8_array = val::global("Uint8Array");
+	const val bytes = data["buffer"].isUndefined() ? uint8_array.new_(data, 0, len)
+	                                                : uint8_array.new_(data["buffer"], data["byteOffset"], len);
 	std::vector<char> file_buffer(len);
-	std::memcpy(file_buffer.data(), data.data(), file_buffer.size());
-	initialize_draftbots(file_buffer);
+	val(typed_memory_view(file_buffer.size(), reinterpret_cast<unsigned char*>(file_buffer.data()))).call<void>("set", bytes);
 	std::vector<std::string> oracle_ids;
-	oracle_ids.reserve(details::card_lookups.size());
-	for (const auto pair : details::card_lookups) {
-		oracle_ids.push_back(pair.first);
+	if (!initialize_draftbots(std::move(file_buffer))) return oracle_ids;
+	oracle_ids.reserve(details::card_table.size());
+	for (const details::OracleId& oracle_id : details::card_table.oracle_ids) {
+		oracle_ids.push_back(details::format_oracle_id(oracle_id));
 	}
 	return oracle_ids;
 };
 
+// data holds the trained probability table as written by ProbTable::save. It has to be loaded before the params, any
+// slab a card list needed before then was already generated.
+bool initialize_prob_table_with_data(val data, int len) {
+	const val uint8_array = val::global("Uint8Array");
+	const val bytes = data["buffer"].isUndefined() ? uint8_array.new_(data, 0, len)
+	                                                : uint8_array.new_(data["buffer"], data["byteOffset"], len);
+	std::vector<char> file_buffer(len);
+	val(typed_memory_view(file_buffer.size(), reinterpret_cast<unsigned char*>(file_buffer.data()))).call<void>("set", bytes);
+	return details::prob_table.load(std::span<const char>(file_buffer));
+}
+
+// request is a Uint8Array holding an encoded PickRequest. The encoded result is copied out of the heap into its own
+// ArrayBuffer so the worker can transfer it to the main thread instead of cloning it.
+val calculate_pick_binary(val request) {
+	std::vector<std::uint8_t> bytes(request["byteLength"].as<std::size_t>());
+	val(typed_memory_view(bytes.size(), bytes.data())).call<void>("set", request);
+	PickRequest pick_request;
+	const char* reason = nullptr;
+	if (!decode_pick_request(bytes, pick_request, &reason)) {
+		std::cerr << "Invalid pick request: " << reason << std::endl;
+		return val::null();
+	}
+	const std::vector<std::uint8_t> result = calculate_pick_encoded(pick_request);
+	return val(typed_memory_view(result.size(), result.data())).call<val>("slice");
+}
+
+// Like calculate_pick_binary for an encoded batch of requests, crossing into wasm once for all of them.
+val calculate_picks_binary(val batch) {
+	std::vector<std::uint8_t> bytes(batch["byteLength"].as<std::size_t>());
+	val(typed_memory_view(bytes.size(), bytes.data())).call<void>("set", batch);
+	const char* reason = nullptr;
+	const std::vector<std::uint8_t> results = calculate_picks_encoded(bytes, 1, &reason);
+	if (results.empty()) {
+		std::cerr << "Invalid pick batch: " << reason << std::endl;
+		return val::null();
+	}
+	return val(typed_memory_view(results.size(), results.data())).call<val>("slice");
+}
+
+std::string active_instruction_set_name() {
+	return std::string(details::instruction_set_name(details::active_instruction_set()));
+}
+
 EMSCRIPTEN_BINDINGS(mtgdraftbots) {
 	// There's sadly no default way to do this.
 	value_array<Lands>("Lands")
@@ -134,6 +184,10 @@ EMSCRIPTEN_BINDINGS(mtgdraftbots) {
 		.field("recognized", &BotResult::recognized)
 		.field("scores", &BotResult::scores);
 	function("calculatePickFromOptions", &calculate_pick_from_options);
+	function("calculatePickBinary", &calculate_pick_binary);
+	function("calculatePicksBinary", &calculate_picks_binary);
 	function("initializeDraftbots", &initialize_with_data);
+	function("initializeProbTable", &initialize_prob_table_with_data);
 	function("testRecognized", &test_recognized);
+	function("activeInstructionSet", &active_instruction_set_name);
 }
\ No newline at end of file
@@ -0,0 +1,418 @@
+// Node-API addon exposing the same surface as the wasm worker. Arguments are converted on the JS thread, the picks
+// themselves run on the libuv thread pool and resolve a promise when they finish.
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <node_api.h>
+
+#include "mtgdraftbots/mtgdraftbots.hpp"
+
+using namespace mtgdraftbots;
+
+namespace {
+    // Throws a JS error and returns nullptr from the enclosing function if a Node-API call fails.
+#define NAPI_CALL(env, call)                                                             \
+    do {                                                                                 \
+        if ((call) != napi_ok) {                                                         \
+            bool is_pending = false;                                                     \
+            napi_is_exception_pending((env), &is_pending);                               \
+            if (!is_pending) napi_throw_error((env), nullptr, "Node-API call failed: " #call); \
+            return nullptr;                                                              \
+        }                                                                                \
+    } while (false)
+
+    bool get_uint(napi_env env, napi_value value, unsigned int& out) {
+        std::uint32_t result;
+        if (napi_get_value_uint32(env, value, &result) != napi_ok) return false;
+        out = result;
+        return true;
+    }
+
+    bool get_string(napi_env env, napi_value value, std::string& out) {
+        std::size_t length;
+        if (napi_get_value_string_utf8(env, value, nullptr, 0, &length) != napi_ok) return false;
+        out.resize(length);
+        return napi_get_value_string_utf8(env, value, out.data(), length + 1, &length) == napi_ok;
+    }
+
+    template <typename T, typename GetElement>
+    bool get_array(napi_env env, napi_value value, std::vector<T>& out, GetElement&& get_element) {
+        bool is_array = false;
+        std::uint32_t length;
+        if (napi_is_array(env, value, &is_array) != napi_ok || !is_array
+            || napi_get_array_length(env, value, &length) != napi_ok) return false;
+        out.resize(length);
+        for (std::uint32_t i = 0; i < length; i++) {
+            napi_value element;
+            if (napi_get_element(env, value, i, &element) != napi_ok || !get_element(env, element, out[i])) return false;
+        }
+        return true;
+    }
+
+    bool get_uints(napi_env env, napi_value value, std::vector<unsigned int>& out) {
+        return get_array(env, value, out, get_uint);
+    }
+
+    bool get_options(napi_env env, napi_value value, std::vector<Option>& out) {
+        return get_array(env, value, out, get_uints);
+    }
+
+    template <typename T, typename GetField>
+    bool get_field(napi_env env, napi_value object, const char* name, T& out, GetField&& get_value) {
+        napi_value field;
+        return napi_get_named_property(env, object, name, &field) == napi_ok && get_value(env, field, out);
+    }
+
+    bool get_drafter_state(napi_env env, napi_value value, DrafterState& out) {
+        const auto get_strings = [](napi_env env_, napi_value strings, std::vector<std::string>& result) {
+            return get_array(env_, strings, result, get_string);
+        };
+        return get_field(env, value, "picked", out.picked, get_uints)
+            && get_field(env, value, "seen", out.seen, get_uints)
+            && get_field(env, value, "cardsInPack", out.cards_in_pack, get_uints)
+            && get_field(env, value, "basics", out.basics, get_uints)
+            && get_field(env, value, "cardOracleIds", out.card_oracle_ids, get_strings)
+            && get_field(env, value, "packNum", out.pack_num, get_uint)
+            && get_field(env, value, "numPacks", out.num_packs, get_uint)
+            && get_field(env, value, "pickNum", out.pick_num, get_uint)
+            && get_field(env, value, "numPicks", out.num_picks, get_uint)
+            && get_field(env, value, "seed", out.seed, get_uint);
+    }
+
+    napi_value make_number(napi_env env, double value) {
+        napi_value result;
+        NAPI_CALL(env, napi_create_double(env, value, &result));
+        return result;
+    }
+
+    napi_value make_string(napi_env env, const std::string& value) {
+        napi_value result;
+        NAPI_CALL(env, napi_create_string_utf8(env, value.data(), value.size(), &result));
+        return result;
+    }
+
+    template <typename Range, typename MakeElement>
+    napi_value make_array(napi_env env, const Range& values, MakeElement&& make_element) {
+        napi_value result;
+        NAPI_CALL(env, napi_create_array_with_length(env, std::size(values), &result));
+        std::uint32_t i = 0;
+        for (const auto& value : values) {
+            napi_value element = make_element(env, value);
+            if (element == nullptr) return nullptr;
+            NAPI_CALL(env, napi_set_element(env, result, i++, element));
+        }
+        return result;
+    }
+
+    napi_value make_numbers(napi_env env, const auto& values) {
+        return make_array(env, values, [](napi_env env_, auto value) { return make_number(env_, static_cast<double>(value)); });
+    }
+
+    napi_value make_object(napi_env env, std::initializer_list<std::pair<const char*, napi_value>> fields) {
+        napi_value result;
+        NAPI_CALL(env, napi_create_object(env, &result));
+        for (const auto& [name, value] : fields) {
+            if (value == nullptr) return nullptr;
+            NAPI_CALL(env, napi_set_named_property(env, result, name, value));
+        }
+        return result;
+    }
+
+    napi_value make_bot_score(napi_env env, const BotScore& score) {
+        const auto make_oracle_result = [](napi_env env_, const OracleResult& oracle_result) {
+            return make_object(env_, {
+                { "title", make_string(env_, oracle_result.title) },
+                { "tooltip", make_string(env_, oracle_result.tooltip) },
+                { "weight", make_number(env_, oracle_result.weight) },
+                { "value", make_number(env_, oracle_result.value) },
+                { "per_card", make_numbers(env_, oracle_result.per_card) },
+            });
+        };
+        return make_object(env, {
+            { "score", make_number(env, score.score) },
+            { "oracleResults", make_array(env, score.oracle_results, make_oracle_result) },
+            { "lands", make_numbers(env, score.lands) },
+        });
+    }
+
+    // The same object the embind bindings build, with the drafter state echoed back.
+    napi_value make_bot_result(napi_env env, const BotResult& result) {
+        return make_object(env, {
+            { "picked", make_numbers(env, result.picked) },
+            { "seen", make_numbers(env, result.seen) },
+            { "cardsInPack", make_numbers(env, result.cards_in_pack) },
+            { "basics", make_numbers(env, result.basics) },
+            { "cardOracleIds", make_array(env, result.card_oracle_ids, make_string) },
+            { "packNum", make_number(env, result.pack_num) },
+            { "numPacks", make_number(env, result.num_packs) },
+            { "pickNum", make_number(env, result.pick_num) },
+            { "numPicks", make_number(env, result.num_picks) },
+            { "seed", make_number(env, result.seed) },
+            { "options", make_array(env, result.options, [](napi_env env_, const Option& option) { return make_numbers(env_, option); }) },
+            { "chosenOption", make_number(env, result.chosen_option) },
+            { "recognized", make_numbers(env, result.recognized) },
+            { "scores", make_array(env, result.scores, make_bot_score) },
+        });
+    }
+
+    // Without explain the scores only hold the score and lands of each option, like the wire format.
+    napi_value make_lean_bot_result(napi_env env, const DrafterState& drafter_state, const std::vector<Option>& options,
+                                    const LeanBotResult& result) {
+        const BotResult echoed{ drafter_state, options, {}, {}, result.chosen_option };
+        napi_value object = make_bot_result(env, echoed);
+        if (object == nullptr) return nullptr;
+        napi_value scores;
+        NAPI_CALL(env, napi_create_array_with_length(env, result.scores.size(), &scores));
+        for (std::uint32_t i = 0; i < result.scores.size(); i++) {
+            napi_value score = make_object(env, { { "score", make_number(env, result.scores[i]) },
+                                                  { "lands", make_numbers(env, result.lands[i]) } });
+            if (score == nullptr) return nullptr;
+            NAPI_CALL(env, napi_set_element(env, scores, i, score));
+        }
+        NAPI_CALL(env, napi_set_named_property(env, object, "scores", scores));
+        return object;
+    }
+
+    // Picks hold this shared while they run and initializeDraftbots holds it exclusively while it replaces the
+    // params, so the card table is never swapped under a running pick.
+    std::shared_mutex params_mutex;
+
+    // State shared between the JS thread, which fills in the inputs and builds the result, and the pool thread that
+    // runs execute.
+    struct PickWork {
+        napi_async_work work{ nullptr };
+        napi_deferred deferred{ nullptr };
+        std::vector<DrafterState> drafter_states;
+        std::vector<std::vector<Option>> options;
+        bool explain{ true };
+        bool batch{ false };
+        std::vector<std::variant<BotResult, LeanBotResult>> results;
+        // Set when scoring threw, the promise is rejected instead of resolved.
+        bool failed{ false };
+        // For initializeDraftbots.
+        std::variant<std::monostate, std::string, std::vector<char>> params;
+        bool initialized{ false };
+    };
+
+    // A batch is one task on the libuv pool so it gets threads of its own, but every pool thread can be running a
+    // batch at once. Each gets its share of the cores so the batches together do not start more threads than there
+    // are cores.
+    std::size_t batch_threads() {
+        static const std::size_t num_threads = []() {
+            std::size_t pool_size = 4;
+            if (const char* size = std::getenv("UV_THREADPOOL_SIZE"); size != nullptr) {
+                pool_size = std::max<std::size_t>(1, std::strtoul(size, nullptr, 10));
+            }
+            return std::max<std::size_t>(1, std::thread::hardware_concurrency() / pool_size);
+        }();
+        return num_threads;
+    }
+
+    void execute_picks(napi_env, void* data) {
+        PickWork& pick_work = *static_cast<PickWork*>(data);
+        const std::shared_lock lock(params_mutex);
+        const std::size_t num_seats = pick_work.drafter_states.size();
+        pick_work.results.resize(num_seats);
+        // Nothing may be thrown back into libuv.
+        try {
+            details::score_seats(
+                num_seats, [&](std::size_t seat) -> const std::vector<std::string>& { return pick_work.drafter_states[seat].card_oracle_ids; },
+                [&](std::size_t seat, const details::CardValues& cards, const std::vector<int>& recognized) {
+                    if (pick_work.explain) {
+                        pick_work.results[seat] = calculate_pick_with_cards(pick_work.drafter_states[seat], pick_work.options[seat], cards, recognized);
+                    } else {
+                        pick_work.results[seat] = calculate_lean_pick_with_cards(pick_work.drafter_states[seat], pick_work.options[seat], cards);
+                    }
+                },
+                pick_work.batch ? batch_threads() : 1);
+        } catch (...) {
+            pick_work.failed = true;
+        }
+    }
+
+    napi_value make_pick_result(napi_env env, const PickWork& pick_work, std::size_t seat) {
+        if (const auto* result = std::get_if<BotResult>(&pick_work.results[seat])) return make_bot_result(env, *result);
+        return make_lean_bot_result(env, pick_work.drafter_states[seat], pick_work.options[seat],
+                                    std::get<LeanBotResult>(pick_work.results[seat]));
+    }
+
+    void complete_picks(napi_env env, napi_status status, void* data) {
+        std::unique_ptr<PickWork> pick_work(static_cast<PickWork*>(data));
+        napi_value result = nullptr;
+        if (status == napi_ok && !pick_work->failed) {
+            if (pick_work->batch) {
+                napi_create_array_with_length(env, pick_work->results.size(), &result);
+                for (std::uint32_t seat = 0; result != nullptr && seat < pick_work->results.size(); seat++) {
+                    napi_value element = make_pick_result(env, *pick_work, seat);
+                    if (element == nullptr || napi_set_element(env, result, seat, element) != napi_ok) result = nullptr;
+                }
+            } else {
+                result = make_pick_result(env, *pick_work, 0);
+            }
+        }
+        if (result != nullptr) {
+            napi_resolve_deferred(env, pick_work->deferred, result);
+        } else {
+            napi_value error, message;
+            napi_get_and_clear_last_exception(env, &error);
+            napi_create_string_utf8(env, "Could not calculate the picks.", NAPI_AUTO_LENGTH, &message);
+            napi_create_error(env, nullptr, message, &error);
+            napi_reject_deferred(env, pick_work->deferred, error);
+        }
+        napi_delete_async_work(env, pick_work->work);
+    }
+
+    napi_value queue_work(napi_env env, std::unique_ptr<PickWork> pick_work, const char* name,
+                          napi_async_execute_callback execute, napi_async_complete_callback complete) {
+        napi_value promise, resource_name;
+        NAPI_CALL(env, napi_create_promise(env, &pick_work->deferred, &promise));
+        NAPI_CALL(env, napi_create_string_utf8(env, name, NAPI_AUTO_LENGTH, &resource_name));
+        NAPI_CALL(env, napi_create_async_work(env, nullptr, resource_name, execute, complete, pick_work.get(), &pick_work->work));
+        NAPI_CALL(env, napi_queue_async_work(env, pick_work->work));
+        pick_work.release();
+        return promise;
+    }
+
+    // Throws the same range errors decode_pick_request rejects a request for as a TypeError.
+    bool check_pick(napi_env env, const DrafterState& drafter_state, const std::vector<Option>& options) {
+        const char* reason = details::invalid_pick_reason(drafter_state, options);
+        if (reason != nullptr) napi_throw_type_error(env, nullptr, reason);
+        return reason == nullptr;
+    }
+
+    bool get_explain(napi_env env, std::size_t argc, napi_value* argv, std::size_t index, bool& explain) {
+        napi_valuetype type = napi_undefined;
+        if (argc <= index || napi_typeof(env, argv[index], &type) != napi_ok || type == napi_undefined) return true;
+        return napi_get_value_bool(env, argv[index], &explain) == napi_ok;
+    }
+
+    // calculatePickFromOptions(drafterState, options, explain = true) -> Promise<BotResult>
+    napi_value calculate_pick_from_options_js(napi_env env, napi_callback_info info) {
+        std::size_t argc = 3;
+        napi_value argv[3];
+        NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr));
+        auto pick_work = std::make_unique<PickWork>();
+        pick_work->drafter_states.resize(1);
+        pick_work->options.resize(1);
+        if (argc < 2 || !get_drafter_state(env, argv[0], pick_work->drafter_states[0])
+            || !get_options(env, argv[1], pick_work->options[0]) || !get_explain(env, argc, argv, 2, pick_work->explain)) {
+            napi_throw_type_error(env, nullptr, "Expected a DrafterState and an array of options.");
+            return nullptr;
+        }
+        if (!check_pick(env, pick_work->drafter_states[0], pick_work->options[0])) return nullptr;
+        return queue_work(env, std::move(pick_work), "calculatePickFromOptions", execute_picks, complete_picks);
+    }
+
+    // calculatePicksBatch(drafterStates, optionsPerState, explain = true) -> Promise<BotResult[]>
+    napi_value calculate_picks_batch_js(napi_env env, napi_callback_info info) {
+        std::size_t argc = 3;
+        napi_value argv[3];
+        NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr));
+        auto pick_work = std::make_unique<PickWork>();
+        pick_work->batch = true;
+        if (argc < 2 || !get_array(env, argv[0], pick_work->drafter_states, get_drafter_state)
+            || !get_array(env, argv[1], pick_work->options, get_options)
+            || pick_work->options.size() != pick_work->drafter_states.size() || !get_explain(env, argc, argv, 2, pick_work->explain)) {
+            napi_throw_type_error(env, nullptr, "Expected an array of DrafterStates and the options for each.");
+            return nullptr;
+        }
+        for (std::size_t seat = 0; seat < pick_work->drafter_states.size(); seat++) {
+            if (!check_pick(env, pick_work->drafter_states[seat], pick_work->options[seat])) return nullptr;
+        }
+        return queue_work(env, std::move(pick_work), "calculatePicksBatch", execute_picks, complete_picks);
+    }
+
+    void execute_initialize(napi_env, void* data) {
+        PickWork& pick_work = *static_cast<PickWork*>(data);
+        const std::unique_lock lock(params_mutex);
+        if (const auto* path = std::get_if<std::string>(&pick_work.params)) {
+            pick_work.initialized = initialize_draftbots_from_file(*path);
+        } else {
+            pick_work.initialized = initialize_draftbots(std::move(std::get<std::vector<char>>(pick_work.params)));
+        }
+    }
+
+    void complete_initialize(napi_env env, napi_status status, void* data) {
+        std::unique_ptr<PickWork> pick_work(static_cast<PickWork*>(data));
+        napi_value result;
+        napi_get_boolean(env, status == napi_ok && pick_work->initialized, &result);
+        napi_resolve_deferred(env, pick_work->deferred, result);
+        napi_delete_async_work(env, pick_work->work);
+    }
+
+    // initializeDraftbots(pathOrBuffer) -> Promise<boolean>. A path is memory mapped, a Buffer, ArrayBuffer or typed
+    // array is copied once. Picks already running finish with the old params before they are replaced.
+    napi_value initialize_draftbots_js(napi_env env, napi_callback_info info) {
+        std::size_t argc = 1;
+        napi_value argv[1];
+        NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr));
+        auto pick_work = std::make_unique<PickWork>();
+        bool is_typed_array = false, is_array_buffer = false;
+        std::string path;
+        void* data = nullptr;
+        std::size_t length = 0;
+        if (argc < 1) {
+            napi_throw_type_error(env, nullptr, "Expected a path or the params.");
+            return nullptr;
+        } else if (get_string(env, argv[0], path)) {
+            pick_work->params = std::move(path);
+        } else if (napi_is_typedarray(env, argv[0], &is_typed_array) == napi_ok && is_typed_array) {
+            napi_typedarray_type type;
+            NAPI_CALL(env, napi_get_typedarray_info(env, argv[0], &type, &length, &data, nullptr, nullptr));
+            if (type != napi_uint8_array) {
+                napi_throw_type_error(env, nullptr, "The params must be a Uint8Array or Buffer.");
+                return nullptr;
+            }
+            pick_work->params = std::vector<char>(static_cast<const char*>(data), static_cast<const char*>(data) + length);
+        } else if (napi_is_arraybuffer(env, argv[0], &is_array_buffer) == napi_ok && is_array_buffer) {
+            NAPI_CALL(env, napi_get_arraybuffer_info(env, argv[0], &data, &length));
+            pick_work->params = std::vector<char>(static_cast<const char*>(data), static_cast<const char*>(data) + length);
+        } else {
+            napi_throw_type_error(env, nullptr, "Expected a path or the params.");
+            return nullptr;
+        }
+        return queue_work(env, std::move(pick_work), "initializeDraftbots", execute_initialize, complete_initialize);
+    }
+
+    // testRecognized(oracleIds) -> number[]
+    napi_value test_recognized_js(napi_env env, napi_callback_info info) {
+        std::size_t argc = 1;
+        napi_value argv[1];
+        NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr));
+        std::vector<std::string> oracle_ids;
+        if (argc < 1 || !get_array(env, argv[0], oracle_ids, get_string)) {
+            napi_throw_type_error(env, nullptr, "Expected an array of oracle ids.");
+            return nullptr;
+        }
+        const std::shared_lock lock(params_mutex);
+        return make_numbers(env, test_recognized(oracle_ids));
+    }
+
+    // activeInstructionSet() -> string
+    napi_value active_instruction_set_js(napi_env env, napi_callback_info) {
+        return make_string(env, std::string(details::instruction_set_name(details::active_instruction_set())));
+    }
+
+    napi_value init(napi_env env, napi_value exports) {
+        const napi_property_descriptor properties[] = {
+            { "calculatePickFromOptions", nullptr, calculate_pick_from_options_js, nullptr, nullptr, nullptr, napi_default, nullptr },
+            { "calculatePicksBatch", nullptr, calculate_picks_batch_js, nullptr, nullptr, nullptr, napi_default, nullptr },
+            { "initializeDraftbots", nullptr, initialize_draftbots_js, nullptr, nullptr, nullptr, napi_default, nullptr },
+            { "testRecognized", nullptr, test_recognized_js, nullptr, nullptr, nullptr, napi_default, nullptr },
+            { "activeInstructionSet", nullptr, active_instruction_set_js, nullptr, nullptr, nullptr, napi_default, nullptr },
+        };
+        NAPI_CALL(env, napi_define_properties(env, exports, std::size(properties), properties));
+        return exports;
+    }
+}
+
+NAPI_MODULE(MtgDraftBotsNodeAddon, init)
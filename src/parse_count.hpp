@@ -0,0 +1,24 @@
+#ifndef MTGDRAFTBOTS_SRC_PARSE_COUNT_HPP
+#define MTGDRAFTBOTS_SRC_PARSE_COUNT_HPP
+
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <system_error>
+
+// Command line parsing shared by the tools in src.
+
+// A positive count from the command line that fits in out, anything else is reported and rejected. With allow_zero
+// 0 is accepted as well, e.g. for seeds.
+template <typename T>
+bool parse_count(const char* arg, const char* name, T& out, bool allow_zero = false) {
+    const char* end = arg + std::strlen(arg);
+    const auto [position, error] = std::from_chars(arg, end, out);
+    if (error != std::errc{} || position != end || (out == 0 && !allow_zero)) {
+        std::cerr << "The " << name << " has to be a " << (allow_zero ? "non negative" : "positive")
+                  << " integer, got " << arg << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+#endif
@@ -0,0 +1,250 @@
+// Serves picks over a Unix domain socket. The params are loaded once, concurrent requests from every connection go
+// through one queue, and a fixed pool of workers each takes its share of what has queued up as a batch, so requests
+// that share a cube only resolve its card list once.
+//
+// Every frame starts with its length in bytes, not counting the length itself, as a little endian uint32.
+//   Request:  length, request_id, deadline_ms, then a PickRequest encoded as in mtgdraftbots/wire.hpp.
+//             deadline_ms counts from when the request was read, 0 uses the default deadline.
+//   Response: length, request_id, status, then for STATUS_OK the encoded result.
+// Responses on a connection can come back in a different order than the requests were sent.
+//
+// The whole probability table is generated before serving so no request waits on it. With a prob table cache path
+// it is read from that file, or generated and written there when the file does not exist yet.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <fmt/core.h>
+#include <moodycamel/blockingconcurrentqueue.h>
+
+#include "mtgdraftbots/mtgdraftbots.hpp"
+#include "mtgdraftbots/wire.hpp"
+
+#include "parse_count.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::uint32_t STATUS_OK = 0;
+constexpr std::uint32_t STATUS_INVALID_REQUEST = 1;
+constexpr std::uint32_t STATUS_DEADLINE_EXCEEDED = 2;
+
+constexpr std::uint32_t MAX_FRAME_SIZE = 64 * 1024 * 1024;
+constexpr std::chrono::milliseconds DEFAULT_DEADLINE{ 1'000 };
+constexpr std::size_t DEFAULT_MAX_BATCH_SIZE = 32;
+constexpr std::int64_t TIMEOUT_USECS = 100'000; // 100 milliseconds
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+void request_stop(int) { stop_requested = 1; }
+
+struct Connection {
+    int fd;
+    std::mutex write_mutex;
+    std::atomic<bool> reader_done{ false };
+
+    explicit Connection(int fd_) noexcept : fd(fd_) { }
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+    ~Connection() { close(fd); }
+
+    bool read_exact(void* data, std::size_t size) noexcept {
+        char* position = static_cast<char*>(data);
+        while (size > 0) {
+            const ssize_t num_read = read(fd, position, size);
+            if (num_read <= 0) return false;
+            position += num_read;
+            size -= static_cast<std::size_t>(num_read);
+        }
+        return true;
+    }
+
+    // Writes one whole frame, a connection whose peer went away just drops it.
+    void write_frame(std::uint32_t request_id, std::uint32_t status, std::span<const std::uint8_t> body) {
+        const std::uint32_t header[3]{ static_cast<std::uint32_t>(2 * sizeof(std::uint32_t) + body.size()), request_id, status };
+        std::vector<std::uint8_t> frame(sizeof(header) + body.size());
+        std::memcpy(frame.data(), header, sizeof(header));
+        if (!body.empty()) std::memcpy(frame.data() + sizeof(header), body.data(), body.size());
+        const std::lock_guard lock(write_mutex);
+        std::size_t written = 0;
+        while (written < frame.size()) {
+            const ssize_t num_written = send(fd, frame.data() + written, frame.size() - written, MSG_NOSIGNAL);
+            if (num_written <= 0) return;
+            written += static_cast<std::size_t>(num_written);
+        }
+    }
+};
+
+struct Job {
+    std::shared_ptr<Connection> connection;
+    std::uint32_t request_id{ 0 };
+    Clock::time_point deadline;
+    std::vector<std::uint8_t> request;
+};
+
+struct ServiceStats {
+    std::atomic<std::size_t> num_requests{ 0 };
+    std::atomic<std::size_t> num_batches{ 0 };
+    std::atomic<std::size_t> num_invalid{ 0 };
+    std::atomic<std::size_t> num_deadline_exceeded{ 0 };
+};
+
+void read_requests(std::shared_ptr<Connection> connection, moodycamel::BlockingConcurrentQueue<Job>& jobs) {
+    moodycamel::ProducerToken jobs_producer(jobs);
+    while (true) {
+        std::uint32_t header[3];
+        if (!connection->read_exact(header, sizeof(header))) break;
+        const auto [length, request_id, deadline_ms] = header;
+        if (length < 2 * sizeof(std::uint32_t) || length > MAX_FRAME_SIZE) {
+            std::cerr << "Closing a connection that sent a frame of " << length << " bytes." << std::endl;
+            break;
+        }
+        Job job{ connection, request_id,
+                 Clock::now() + (deadline_ms > 0 ? std::chrono::milliseconds(deadline_ms) : DEFAULT_DEADLINE),
+                 std::vector<std::uint8_t>(length - 2 * sizeof(std::uint32_t)) };
+        if (!connection->read_exact(job.request.data(), job.request.size())) break;
+        jobs.enqueue(jobs_producer, std::move(job));
+    }
+    shutdown(connection->fd, SHUT_RD);
+    connection->reader_done = true;
+}
+
+// Requests are checked against their deadline right before they are scored, those already past it are answered
+// without being scored. A pick that finishes after its deadline is still answered with STATUS_DEADLINE_EXCEEDED,
+// since the client has stopped waiting for it.
+//
+// Each worker only takes its share of what has queued up, so a burst is spread over the workers instead of being
+// scored as one batch while the others wait.
+void process_jobs(std::stop_token stop_tkn, moodycamel::BlockingConcurrentQueue<Job>& jobs, std::size_t num_workers,
+                  std::size_t max_batch_size, ServiceStats& stats) {
+    moodycamel::ConsumerToken jobs_consumer(jobs);
+    std::vector<Job> batch;
+    batch.reserve(max_batch_size);
+    std::vector<std::span<const std::uint8_t>> messages;
+    std::vector<std::uint8_t> expired;
+    std::vector<const char*> reasons;
+    while (!stop_tkn.stop_requested()) {
+        batch.clear();
+        const std::size_t share = std::clamp((jobs.size_approx() + num_workers - 1) / num_workers, std::size_t{ 1 }, max_batch_size);
+        if (jobs.wait_dequeue_bulk_timed(jobs_consumer, std::back_inserter(batch), share, TIMEOUT_USECS) == 0) continue;
+        stats.num_requests += batch.size();
+        stats.num_batches++;
+        messages.clear();
+        for (const Job& job : batch) messages.emplace_back(job.request);
+        expired.assign(batch.size(), 0);
+        const std::vector<std::vector<std::uint8_t>> results = mtgdraftbots::calculate_picks_encoded(
+            std::span<const std::span<const std::uint8_t>>(messages), 1, [&](std::size_t i) {
+                expired[i] = batch[i].deadline <= Clock::now();
+                return !expired[i];
+            }, &reasons);
+        const Clock::time_point end = Clock::now();
+        for (std::size_t i = 0; i < batch.size(); i++) {
+            const Job& job = batch[i];
+            if (expired[i] || (!results[i].empty() && job.deadline <= end)) {
+                job.connection->write_frame(job.request_id, STATUS_DEADLINE_EXCEEDED, {});
+                stats.num_deadline_exceeded++;
+            } else if (results[i].empty()) {
+                if (reasons[i] != nullptr) std::cerr << "Invalid pick request: " << reasons[i] << std::endl;
+                job.connection->write_frame(job.request_id, STATUS_INVALID_REQUEST, {});
+                stats.num_invalid++;
+            } else {
+                job.connection->write_frame(job.request_id, STATUS_OK, results[i]);
+            }
+        }
+    }
+}
+
+int listen_on(const std::string& socket_path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "The socket path " << socket_path << " is too long." << std::endl;
+        return -1;
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socket_path.c_str());
+    if (fd < 0 || bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        std::cerr << "Could not listen on " << socket_path << ": " << std::strerror(errno) << std::endl;
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3 || argc > 6) {
+        std::cerr << "Usage: " << argv[0] << " <params> <socket path> [num threads] [max batch size] [prob table cache]"
+                  << std::endl;
+        return 1;
+    }
+    const std::string socket_path = argv[2];
+    std::size_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t max_batch_size = DEFAULT_MAX_BATCH_SIZE;
+    if ((argc > 3 && !parse_count(argv[3], "number of threads", num_threads))
+        || (argc > 4 && !parse_count(argv[4], "max batch size", max_batch_size))) {
+        return 1;
+    }
+    if (!mtgdraftbots::initialize_draftbots_from_file(argv[1])) return 1;
+    // Without the cache the table is still complete, it just has to be generated again on the next start.
+    mtgdraftbots::initialize_prob_table(num_threads, argc > 5 ? argv[5] : "");
+    const int listen_fd = listen_on(socket_path);
+    if (listen_fd < 0) return 1;
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    moodycamel::BlockingConcurrentQueue<Job> jobs;
+    ServiceStats stats;
+    std::vector<std::jthread> workers;
+    workers.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; i++) {
+        workers.emplace_back([&](std::stop_token stop_tkn) { process_jobs(stop_tkn, jobs, num_threads, max_batch_size, stats); });
+    }
+    fmt::print("Serving picks on {} with {} threads and batches of up to {}.\n", socket_path, num_threads, max_batch_size);
+    std::fflush(stdout);
+
+    std::vector<std::pair<std::shared_ptr<Connection>, std::jthread>> connections;
+    while (!stop_requested) {
+        pollfd listen_poll{ listen_fd, POLLIN, 0 };
+        if (poll(&listen_poll, 1, 200) <= 0) continue;
+        const int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) continue;
+        std::erase_if(connections, [](const auto& connection) { return connection.first->reader_done.load(); });
+        auto connection = std::make_shared<Connection>(fd);
+        connections.emplace_back(connection, std::jthread(read_requests, connection, std::ref(jobs)));
+    }
+
+    close(listen_fd);
+    unlink(socket_path.c_str());
+    for (auto& [connection, reader] : connections) shutdown(connection->fd, SHUT_RD);
+    connections.clear();
+    workers.clear();
+    const std::size_t num_batches = stats.num_batches;
+    fmt::print("Served {} requests in {} batches ({:.2f} per batch), {} invalid and {} past their deadline.\n",
+               stats.num_requests.load(), num_batches,
+               num_batches > 0 ? static_cast<double>(stats.num_requests) / num_batches : 0.0,
+               stats.num_invalid.load(), stats.num_deadline_exceeded.load());
+    fmt::print("Land combinations cache: {} hits, {} misses.\n", mtgdraftbots::details::generate_probs_cache.hits(),
+               mtgdraftbots::details::generate_probs_cache.misses());
+    return 0;
+}
@@ -0,0 +1,114 @@
+// Runs bot only drafts over a cube and writes their pick logs, one JSON object per line.
+//
+// The cube list has one oracle id per line. Lines after one reading [basics] are the basic lands every seat can add
+// to its deck instead of cards of the cube. Empty lines and lines starting with # are skipped. Card indices in the
+// logs are into the cube followed by the basics, in the order they were listed.
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "mtgdraftbots/draft_simulator.hpp"
+#include "mtgdraftbots/mtgdraftbots.hpp"
+
+#include "parse_count.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+bool read_cube_list(const std::string& path, std::vector<std::string>& cube, std::vector<std::string>& basics) {
+    std::ifstream input(path);
+    if (!input) {
+        std::cerr << "Could not open the cube list " << path << '.' << std::endl;
+        return false;
+    }
+    std::vector<std::string>* section = &cube;
+    std::string line;
+    while (std::getline(input, line)) {
+        const auto is_space = [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
+        line.erase(std::find_if_not(std::rbegin(line), std::rend(line), is_space).base(), std::end(line));
+        if (line.empty() || line.front() == '#') continue;
+        if (line == "[basics]") section = &basics;
+        else section->push_back(line);
+    }
+    return true;
+}
+
+void write_log(fmt::memory_buffer& buffer, const mtgdraftbots::DraftLog& log) {
+    fmt::format_to(std::back_inserter(buffer), "{{\"seed\":{},\"packs\":[", log.seed);
+    for (std::size_t pack_num = 0; pack_num < log.packs.size(); pack_num++) {
+        if (pack_num > 0) buffer.push_back(',');
+        buffer.push_back('[');
+        for (std::size_t seat = 0; seat < log.packs[pack_num].size(); seat++) {
+            fmt::format_to(std::back_inserter(buffer), "{}[{}]", seat > 0 ? "," : "", fmt::join(log.packs[pack_num][seat], ","));
+        }
+        buffer.push_back(']');
+    }
+    fmt::format_to(std::back_inserter(buffer), "],\"picks\":[");
+    for (std::size_t seat = 0; seat < log.picks.size(); seat++) {
+        fmt::format_to(std::back_inserter(buffer), "{}[{}]", seat > 0 ? "," : "", fmt::join(log.picks[seat], ","));
+    }
+    fmt::format_to(std::back_inserter(buffer), "]}}\n");
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 4 || argc > 10) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <params> <cube list> <pick log> [num drafts] [num seats] [num packs] [pack size] [num threads] [first seed]"
+                  << std::endl;
+        return 1;
+    }
+    std::size_t num_drafts = 100;
+    mtgdraftbots::PodConfig config;
+    std::size_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::uint64_t first_seed = 0;
+    if ((argc > 4 && !parse_count(argv[4], "number of drafts", num_drafts))
+        || (argc > 5 && !parse_count(argv[5], "number of seats", config.num_seats))
+        || (argc > 6 && !parse_count(argv[6], "number of packs", config.num_packs))
+        || (argc > 7 && !parse_count(argv[7], "pack size", config.pack_size))
+        || (argc > 8 && !parse_count(argv[8], "number of threads", num_threads))
+        || (argc > 9 && !parse_count(argv[9], "first seed", first_seed, true))) {
+        return 1;
+    }
+
+    if (!mtgdraftbots::initialize_draftbots_from_file(argv[1])) return 1;
+    std::vector<std::string> cube;
+    std::vector<std::string> basics;
+    if (!read_cube_list(argv[2], cube, basics)) return 1;
+    const std::size_t cube_size = cube.size();
+    const mtgdraftbots::DraftSimulator simulator(std::move(cube), basics, config);
+    if (!simulator.valid()) {
+        std::cerr << "A cube of " << cube_size << " cards cannot fill " << config.num_packs << " packs of " << config.pack_size
+                  << " for " << config.num_seats << " seats." << std::endl;
+        return 1;
+    }
+    std::ofstream output(argv[3], std::ios::binary);
+    if (!output) {
+        std::cerr << "Could not write the pick log " << argv[3] << '.' << std::endl;
+        return 1;
+    }
+
+    std::mutex output_mutex;
+    const auto start = Clock::now();
+    simulator.simulate_many(first_seed, num_drafts, num_threads, [&](const mtgdraftbots::DraftLog& log) {
+        fmt::memory_buffer buffer;
+        write_log(buffer, log);
+        const std::lock_guard lock(output_mutex);
+        output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    });
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    const double num_picks = static_cast<double>(num_drafts * simulator.picks_per_draft());
+    fmt::print("Simulated {} drafts ({} picks) on {} threads in {:.2f} s: {:.2f} drafts/s, {:.1f} picks/s.\n", num_drafts,
+               num_drafts * simulator.picks_per_draft(), num_threads, seconds, num_drafts / seconds, num_picks / seconds);
+    return 0;
+}